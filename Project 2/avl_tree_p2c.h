@@ -2,7 +2,9 @@
 
 #include "dsexceptions.h"
 #include <algorithm>
+#include <future>
 #include <iostream>
+#include <thread>
 using namespace std;
 
 template <typename Comparable>
@@ -63,9 +65,11 @@ public:
     }
 
     /// @brief Find a node in the tree.
-    /// @param x The node to find.
+    /// @tparam Key Any type that can be compared with Comparable in both directions using operator<.
+    /// @param x The node, or key of the node, to find.
     /// @return A constant reference to the node.
-    const Comparable* find(const Comparable& x) const
+    template <typename Key>
+    const Comparable* find(const Key& x) const
     {
         AvlNode* target = find(x, root);
 
@@ -75,35 +79,16 @@ public:
         return &target->element;
     }
 
-    /// @brief Find a node in the tree.
-    /// @param x The rvalue node to find.
-    /// @return A constant reference to the node.
-    const Comparable* find(Comparable&& x) const
-    {
-        AvlNode* target = find(std::move(x), root);
-
-        if (target == nullptr)
-            return nullptr;
-
-        return &target->element;
-    }
-
     /// @brief Counts the amount of recursive calls to find a node in the tree.
-    /// @param x The node to find.
+    /// @tparam Key Any type that can be compared with Comparable in both directions using operator<.
+    /// @param x The node, or key of the node, to find.
     /// @return The amount of recursive calls.
-    int findRecursionCount(const Comparable& x) const
+    template <typename Key>
+    int findRecursionCount(const Key& x) const
     {
         return findRecursionCount(x, root);
     }
 
-    /// @brief Counts the amount of recursive calls to find a node in the tree.
-    /// @param x The rvalue node to find.
-    /// @return The amount of recursive calls.
-    int findRecursionCount(Comparable&& x) const
-    {
-        return findRecursionCount(std::move(x), root);
-    }
-
     /// @brief Find the smallest node in the tree.
     /// @return A constant reference to the smallest node.
     /// @exception UnderflowException If the tree is empty.
@@ -125,9 +110,11 @@ public:
     }
 
     /// @brief Checks to see if the given node is in the tree.
-    /// @param x The node to check.
+    /// @tparam Key Any type that can be compared with Comparable in both directions using operator<.
+    /// @param x The node, or key of the node, to check.
     /// @return True if the node is in the tree, false otherwise.
-    bool contains(const Comparable& x) const
+    template <typename Key>
+    bool contains(const Key& x) const
     {
         return contains(x, root);
     }
@@ -169,20 +156,125 @@ public:
     }
 
     /// @brief Removes a node from the tree.
-    /// @param x The node to remove.
-    void remove(const Comparable& x)
+    /// @tparam Key Any type that can be compared with Comparable in both directions using operator<.
+    /// @param x The node, or key of the node, to remove.
+    template <typename Key>
+    void remove(const Key& x)
     {
         remove(x, root);
     }
 
     /// @brief Counts the amount of recursive calls to remove a node from the tree.
-    /// @param x The node to remove.
+    /// @tparam Key Any type that can be compared with Comparable in both directions using operator<.
+    /// @param x The node, or key of the node, to remove.
     /// @return The amount of recursive calls.
-    int removeRecursionCount(const Comparable& x) const
+    template <typename Key>
+    int removeRecursionCount(const Key& x) const
     {
         return removeRecursionCount(x, root);
     }
 
+    /// @brief Adds every node of another tree to this tree, nodes found in both trees are merged.
+    /// @param rhs The tree to take the nodes from, left empty afterwards.
+    /// @param threads The hardware threads to spread the work over, all of them by default.
+    void unionWith(AvlTree&& rhs, unsigned threads = std::thread::hardware_concurrency())
+    {
+        if (&rhs == this)
+            return;   // Every node already matches itself
+
+        root = unionOf(root, rhs.root, forkBudget(threads));
+        rhs.root = nullptr;
+    }
+
+    /// @brief Adds every node of another tree to this tree, nodes found in both trees are merged.
+    /// @param rhs The tree to copy the nodes from.
+    /// @param threads The hardware threads to spread the work over, all of them by default.
+    void unionWith(const AvlTree& rhs, unsigned threads = std::thread::hardware_concurrency())
+    {
+        if (&rhs == this)
+            return;
+
+        unionWith(AvlTree{ rhs }, threads);
+    }
+
+    /// @brief Keeps only the nodes that are also in another tree, merging each pair.
+    /// @param rhs The tree to intersect with, left empty afterwards.
+    /// @param threads The hardware threads to spread the work over, all of them by default.
+    void intersectionWith(AvlTree&& rhs, unsigned threads = std::thread::hardware_concurrency())
+    {
+        if (&rhs == this)
+            return;   // Every node already matches itself
+
+        root = intersectionOf(root, rhs.root, forkBudget(threads));
+        rhs.root = nullptr;
+    }
+
+    /// @brief Keeps only the nodes that are also in another tree, merging each pair.
+    /// @param rhs The tree to intersect with.
+    /// @param threads The hardware threads to spread the work over, all of them by default.
+    void intersectionWith(const AvlTree& rhs, unsigned threads = std::thread::hardware_concurrency())
+    {
+        if (&rhs == this)
+            return;
+
+        intersectionWith(AvlTree{ rhs }, threads);
+    }
+
+    /// @brief Removes every node that is also in another tree.
+    /// @param rhs The tree of nodes to remove, left empty afterwards.
+    /// @param threads The hardware threads to spread the work over, all of them by default.
+    void differenceWith(AvlTree&& rhs, unsigned threads = std::thread::hardware_concurrency())
+    {
+        if (&rhs == this)
+        {
+            makeEmpty();   // Every node is removed by its own match
+            return;
+        }
+
+        root = differenceOf(root, rhs.root, forkBudget(threads));
+        rhs.root = nullptr;
+    }
+
+    /// @brief Removes every node that is also in another tree.
+    /// @param rhs The tree of nodes to remove.
+    /// @param threads The hardware threads to spread the work over, all of them by default.
+    void differenceWith(const AvlTree& rhs, unsigned threads = std::thread::hardware_concurrency())
+    {
+        if (&rhs == this)
+        {
+            makeEmpty();
+            return;
+        }
+
+        differenceWith(AvlTree{ rhs }, threads);
+    }
+
+    /// @brief Splits the tree around a node, only the node matching x (if any) is kept in this tree.
+    /// @param x The node to split around.
+    /// @param lesser Replaced with every node smaller than x.
+    /// @param greater Replaced with every node larger than x.
+    /// @return True if a node matching x was in the tree, false otherwise.
+    /// @exception IllegalArgumentException If lesser or greater is this tree, or both are the same tree.
+    bool split(const Comparable& x, AvlTree& lesser, AvlTree& greater)
+    {
+        if (&lesser == this || &greater == this || &lesser == &greater)
+            throw IllegalArgumentException{ };
+
+        lesser.makeEmpty();
+        greater.makeEmpty();
+        root = split(root, x, lesser.root, greater.root);
+
+        return root != nullptr;
+    }
+
+    /// @brief Checks the AVL invariants: nodes in order, stored heights correct, and no node out of balance.
+    /// @return True if every invariant holds, false otherwise.
+    bool isBalanced() const
+    {
+        int h;
+        return isBalanced(root, nullptr, nullptr, h);
+    }
+
 private:
     struct AvlNode
     {
@@ -201,6 +293,7 @@ private:
     };
 
     static const int ALLOWED_IMBALANCE = 1;
+    static const int PARALLEL_CUTOFF_HEIGHT = 12;   // Roughly 500+ nodes before forking a task pays off
     AvlNode* root;
 
     int count(AvlNode* t) const
@@ -219,6 +312,28 @@ private:
         return depth + avgDepth(t->left, depth + 1) + avgDepth(t->right, depth + 1);
     }
 
+    /**
+     * Internal method to check the AVL invariants of a subtree.
+     * Every item must be between lo and hi, when they are not nullptr.
+     * h is set to the real height of the subtree.
+     */
+    bool isBalanced(AvlNode* t, const Comparable* lo, const Comparable* hi, int& h) const
+    {
+        if (t == nullptr)
+        {
+            h = -1;
+            return true;
+        }
+
+        int hl, hr;
+        if ((lo != nullptr && !(*lo < t->element)) || (hi != nullptr && !(t->element < *hi))
+            || !isBalanced(t->left, lo, &t->element, hl) || !isBalanced(t->right, &t->element, hi, hr))
+            return false;
+
+        h = max(hl, hr) + 1;
+        return t->height == h && hl - hr <= ALLOWED_IMBALANCE && hr - hl <= ALLOWED_IMBALANCE;
+    }
+
     /**
      * Internal method to insert into a subtree.
      * x is the item to insert.
@@ -259,61 +374,40 @@ private:
         balance(t);
     }
 
-    AvlNode* find(const Comparable& x, AvlNode* t) const
+    template <typename Key>
+    AvlNode* find(const Key& x, AvlNode* t) const
     {
         if (t == nullptr)
             return nullptr;
         else if (x < t->element)
             return find(x, t->left);
-        else if (x > t->element)
+        else if (t->element < x)
             return find(x, t->right);
         else
             return t;
     }
 
-    AvlNode* find(Comparable&& x, AvlNode* t) const
-    {
-        if (t == nullptr)
-            return nullptr;
-        else if (x < t->element)
-            return find(std::move(x), t->left);
-        else if (x > t->element)
-            return find(std::move(x), t->right);
-        else
-            return t;
-    }
-
-    int findRecursionCount(const Comparable& x, AvlNode* t) const
+    template <typename Key>
+    int findRecursionCount(const Key& x, AvlNode* t) const
     {
         if (t == nullptr)
             return 0;
         else if (x < t->element)
             return 1 + findRecursionCount(x, t->left);
-        else if (x > t->element)
+        else if (t->element < x)
             return 1 + findRecursionCount(x, t->right);
 
         return 0;
     }
 
-    int findRecursionCount(Comparable&& x, AvlNode* t) const
-    {
-        if (t == nullptr)
-            return 0;
-        else if (x < t->element)
-            return 1 + findRecursionCount(std::move(x), t->left);
-        else if (x > t->element)
-            return 1 + findRecursionCount(std::move(x), t->right);
-
-        return 0;
-    }
-
     /**
      * Internal method to remove from a subtree.
      * x is the item to remove.
      * t is the node that roots the subtree.
      * Set the new root of the subtree.
      */
-    void remove(const Comparable& x, AvlNode*& t)
+    template <typename Key>
+    void remove(const Key& x, AvlNode*& t)
     {
         if (t == nullptr)
             return;   // Item not found; do nothing
@@ -324,8 +418,12 @@ private:
             remove(x, t->right);
         else if (t->left != nullptr && t->right != nullptr) // Two children
         {
-            t->element = findMin(t->right)->element;
-            remove(t->element, t->right);
+            // Splice the successor node into t's place rather than copying its element.
+            AvlNode* successor = detachMin(t->right);
+            successor->left = t->left;
+            successor->right = t->right;
+            delete t;
+            t = successor;
         }
         else
         {
@@ -337,20 +435,269 @@ private:
         balance(t);
     }
 
-    int removeRecursionCount(const Comparable& x, AvlNode* t) const
+    template <typename Key>
+    int removeRecursionCount(const Key& x, AvlNode* t) const
     {
         if (t == nullptr)
             return 0;
         else if (x < t->element)
             return 1 + removeRecursionCount(x, t->left);
-        else if (x > t->element)
+        else if (t->element < x)
             return 1 + removeRecursionCount(x, t->right);
         else if (t->left != nullptr && t->right != nullptr)
-            return 2 + findMinRecursionCount(t->right) + removeRecursionCount(findMin(t->right)->element, t->right);
+            return detachMinRecursionCount(t->right);   // The successor is spliced out in one descent
 
         return 0;
     }
 
+    /**
+     * Internal method to join two subtrees around a middle node.
+     * Every item in tl is smaller than k->element, every item in tr is larger.
+     * Runs in O(|height(tl) - height(tr)|); return the root of the joined subtree.
+     */
+    AvlNode* join(AvlNode* tl, AvlNode* k, AvlNode* tr)
+    {
+        if (height(tl) > height(tr) + ALLOWED_IMBALANCE)
+        {
+            tl->right = join(tl->right, k, tr);
+            balance(tl);
+            return tl;
+        }
+
+        if (height(tr) > height(tl) + ALLOWED_IMBALANCE)
+        {
+            tr->left = join(tl, k, tr->left);
+            balance(tr);
+            return tr;
+        }
+
+        k->left = tl;
+        k->right = tr;
+        k->height = max(height(tl), height(tr)) + 1;
+        return k;
+    }
+
+    /**
+     * Internal method to join two subtrees without a middle node.
+     * Every item in tl is smaller than every item in tr.
+     * Return the root of the joined subtree.
+     */
+    AvlNode* join(AvlNode* tl, AvlNode* tr)
+    {
+        if (tl == nullptr)
+            return tr;
+
+        AvlNode* k = detachMax(tl);
+        return join(tl, k, tr);
+    }
+
+    /**
+     * Internal method to split a subtree around x.
+     * lt is set to the items smaller than x, rt to the items larger than x.
+     * Return the node matching x detached from both halves, or nullptr if there is none.
+     */
+    AvlNode* split(AvlNode* t, const Comparable& x, AvlNode*& lt, AvlNode*& rt)
+    {
+        if (t == nullptr)
+        {
+            lt = rt = nullptr;
+            return nullptr;
+        }
+
+        AvlNode* match;
+        AvlNode* middle;
+
+        if (x < t->element)
+        {
+            match = split(t->left, x, lt, middle);
+            rt = join(middle, t, t->right);
+        }
+        else if (t->element < x)
+        {
+            match = split(t->right, x, middle, rt);
+            lt = join(t->left, t, middle);
+        }
+        else
+        {
+            lt = t->left;
+            rt = t->right;
+            t->left = t->right = nullptr;
+            t->height = 0;
+            match = t;
+        }
+
+        return match;
+    }
+
+    /**
+     * Internal method to detach the smallest node of a subtree t.
+     * Set the new root of the subtree; return the detached node.
+     */
+    AvlNode* detachMin(AvlNode*& t)
+    {
+        if (t->left == nullptr)
+        {
+            AvlNode* minNode = t;
+            t = t->right;
+            minNode->right = nullptr;
+            minNode->height = 0;
+            return minNode;
+        }
+
+        AvlNode* minNode = detachMin(t->left);
+        balance(t);
+        return minNode;
+    }
+
+    /**
+     * Internal method to detach the largest node of a subtree t.
+     * Set the new root of the subtree; return the detached node.
+     */
+    AvlNode* detachMax(AvlNode*& t)
+    {
+        if (t->right == nullptr)
+        {
+            AvlNode* maxNode = t;
+            t = t->left;
+            maxNode->left = nullptr;
+            maxNode->height = 0;
+            return maxNode;
+        }
+
+        AvlNode* maxNode = detachMax(t->right);
+        balance(t);
+        return maxNode;
+    }
+
+    /**
+     * Internal method for the union of two subtrees, both are consumed.
+     * Splitting t2 around the root of t1 leaves two independent halves,
+     * which are combined in parallel while forks remain.
+     */
+    AvlNode* unionOf(AvlNode* t1, AvlNode* t2, int forks)
+    {
+        if (t1 == nullptr)
+            return t2;
+        if (t2 == nullptr)
+            return t1;
+
+        int h = max(height(t1), height(t2));
+        AvlNode* l2;
+        AvlNode* r2;
+        AvlNode* match = split(t2, t1->element, l2, r2);
+
+        if (match != nullptr)
+        {
+            t1->element.Merge(std::move(match->element));
+            delete match;
+        }
+
+        AvlNode* lt;
+        AvlNode* rt;
+        forkJoin(forks, h,
+            [&] { lt = unionOf(t1->left, l2, forks - 1); },
+            [&] { rt = unionOf(t1->right, r2, forks - 1); });
+
+        return join(lt, t1, rt);
+    }
+
+    /**
+     * Internal method for the intersection of two subtrees, both are consumed.
+     * Nodes of t1 without a match in t2 are deleted.
+     */
+    AvlNode* intersectionOf(AvlNode* t1, AvlNode* t2, int forks)
+    {
+        if (t1 == nullptr || t2 == nullptr)
+        {
+            makeEmpty(t1);
+            makeEmpty(t2);
+            return nullptr;
+        }
+
+        int h = max(height(t1), height(t2));
+        AvlNode* l2;
+        AvlNode* r2;
+        AvlNode* match = split(t2, t1->element, l2, r2);
+
+        AvlNode* lt;
+        AvlNode* rt;
+        forkJoin(forks, h,
+            [&] { lt = intersectionOf(t1->left, l2, forks - 1); },
+            [&] { rt = intersectionOf(t1->right, r2, forks - 1); });
+
+        if (match == nullptr)
+        {
+            delete t1;
+            return join(lt, rt);
+        }
+
+        t1->element.Merge(std::move(match->element));
+        delete match;
+        return join(lt, t1, rt);
+    }
+
+    /**
+     * Internal method for the difference of two subtrees, both are consumed.
+     * Return the nodes of t1 that have no match in t2.
+     */
+    AvlNode* differenceOf(AvlNode* t1, AvlNode* t2, int forks)
+    {
+        if (t1 == nullptr || t2 == nullptr)
+        {
+            makeEmpty(t2);
+            return t1;
+        }
+
+        int h = max(height(t1), height(t2));
+        AvlNode* l1;
+        AvlNode* r1;
+        delete split(t1, t2->element, l1, r1);
+
+        AvlNode* lt;
+        AvlNode* rt;
+        forkJoin(forks, h,
+            [&] { lt = differenceOf(l1, t2->left, forks - 1); },
+            [&] { rt = differenceOf(r1, t2->right, forks - 1); });
+
+        delete t2;
+        return join(lt, rt);
+    }
+
+    /**
+     * Internal method to run two independent halves of a set operation.
+     * The left half is forked onto its own thread while forks remain and
+     * the subtrees are tall enough to be worth it, else both run here.
+     */
+    template <typename LeftTask, typename RightTask>
+    void forkJoin(int forks, int h, LeftTask left, RightTask right)
+    {
+        if (forks > 0 && h >= PARALLEL_CUTOFF_HEIGHT)
+        {
+            std::future<void> pending = std::async(std::launch::async, left);
+            right();
+            pending.get();
+        }
+        else
+        {
+            left();
+            right();
+        }
+    }
+
+    /**
+     * Return how many levels of a set operation may fork, enough for
+     * about two tasks per hardware thread.
+     */
+    static int forkBudget(unsigned threads)
+    {
+        int forks = 0;
+
+        while (threads > 1 && (1u << forks) < 2 * threads)
+            ++forks;
+
+        return forks;
+    }
+
     // Assume t is balanced or within one of being balanced
     void balance(AvlNode*& t)
     {
@@ -387,12 +734,15 @@ private:
         return findMin(t->left);
     }
 
-    int findMinRecursionCount(AvlNode* t) const
+    /**
+     * Internal method to count the calls detachMin makes to detach the smallest node of a subtree t.
+     */
+    int detachMinRecursionCount(AvlNode* t) const
     {
-        if (t == nullptr || t->left == nullptr)
-            return 0;
+        if (t->left == nullptr)
+            return 1;
 
-        return 1 + findMinRecursionCount(t->left);
+        return 1 + detachMinRecursionCount(t->left);
     }
 
     /**
@@ -412,7 +762,8 @@ private:
      * x is item to search for.
      * t is the node that roots the tree.
      */
-    bool contains(const Comparable& x, AvlNode* t) const
+    template <typename Key>
+    bool contains(const Key& x, AvlNode* t) const
     {
         if (t == nullptr)
             return false;
@@ -0,0 +1,385 @@
+#pragma once
+
+#include "sequence_map.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	/// @brief Timing and cost of one benchmark.
+	struct BenchmarkResult
+	{
+		double nsPerOp;
+		double nodesPerOp;
+		long peakRssKb;		// Peak resident set size during the benchmark
+		long rssKb;			// Resident set size after the benchmark
+	};
+
+	/// @brief Reads a database file and inserts its SequenceMaps into a tree.
+	/// @tparam TreeType The type of tree to use.
+	/// @param db_filename The name of the file to insert data from.
+	/// @param a_tree The tree to insert the data into.
+	template <typename TreeType>
+	void ReadDatabase(const std::string& db_filename, TreeType& a_tree)
+	{
+		std::ifstream dbFile(db_filename);
+		std::string dbLine;
+
+		// Skip the first 10 lines of the file.
+		for (int i = 0; i < 10; ++i)
+			std::getline(dbFile, dbLine);
+
+		// Read the database file and insert SequenceMaps into the tree.
+		while (dbFile >> dbLine)
+		{
+			std::string enzymeAcronym;
+			std::string recognitionSequence;
+
+			for (size_t i = 0; i < dbLine.size() - 1; ++i)
+			{
+				if (dbLine[i] == '/' && dbLine[i + 1] == '/')
+				{
+					SequenceMap newSequenceMap(recognitionSequence, enzymeAcronym);
+					a_tree.insert(newSequenceMap);
+				}
+				else if (dbLine[i] != '/')
+					recognitionSequence += dbLine[i];
+				else
+				{
+					if (enzymeAcronym.empty())
+						enzymeAcronym = recognitionSequence;
+					else
+					{
+						SequenceMap temp(recognitionSequence, enzymeAcronym);
+						a_tree.insert(temp);
+					}
+
+					recognitionSequence.clear();
+				}
+			}
+		}
+
+		dbFile.close();
+	}
+
+	/// @brief Reads the recognition sequences of a database file, in file order and without repeats.
+	/// @param db_filename The name of the database file.
+	/// @return The recognition sequences.
+	std::vector<std::string> ReadRecognitionSequences(const std::string& db_filename)
+	{
+		std::vector<std::string> sequences;
+		std::ifstream dbFile(db_filename);
+		std::string dbLine;
+
+		for (int i = 0; i < 10; ++i)
+			std::getline(dbFile, dbLine);
+
+		// Every field after the enzyme acronym is a recognition sequence.
+		while (dbFile >> dbLine)
+		{
+			size_t begin = dbLine.find('/');
+			while (begin != std::string::npos && begin + 1 < dbLine.size() && dbLine[begin + 1] != '/')
+			{
+				size_t end = dbLine.find('/', begin + 1);
+				sequences.push_back(dbLine.substr(begin + 1, end - begin - 1));
+				begin = end;
+			}
+		}
+
+		std::set<std::string> seen;
+		std::vector<std::string> unique;
+		for (auto& sequence : sequences)
+			if (seen.insert(sequence).second)
+				unique.push_back(sequence);
+
+		return unique;
+	}
+
+	/// @brief Generates distinct keys for a benchmark.
+	/// random: 16 random bases. sorted: the same keys in ascending order.
+	/// rebase: real recognition sequences taken in turn, each lengthened by a counter written in bases.
+	/// @param distribution One of random, sorted or rebase.
+	/// @param count The amount of keys to generate.
+	/// @param seed The seed for the random keys.
+	/// @param rebaseSequences The recognition sequences the rebase keys are derived from.
+	/// @return The keys.
+	std::vector<std::string> GenerateKeys(const std::string& distribution, size_t count, unsigned seed,
+		const std::vector<std::string>& rebaseSequences)
+	{
+		static const char BASES[] = "ACGT";
+		std::vector<std::string> keys;
+		keys.reserve(count);
+
+		if (distribution == "rebase")
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				std::string key = rebaseSequences[i % rebaseSequences.size()];
+				for (size_t round = i / rebaseSequences.size() + seed * count; round > 0; round /= 4)
+					key += BASES[round % 4];
+				keys.push_back(key);
+			}
+			return keys;
+		}
+
+		std::mt19937_64 rng(seed);
+		for (size_t i = 0; i < count; ++i)
+		{
+			std::string key(16, 'A');
+			for (auto& base : key)
+				base = BASES[rng() % 4];
+			keys.push_back(key);
+		}
+
+		if (distribution == "sorted")
+			std::sort(keys.begin(), keys.end());
+
+		return keys;
+	}
+
+	/// @brief Resets the peak resident set size of the process to its current resident set size, so the next
+	/// PeakRssKb covers only what runs after. Does nothing where /proc/self/clear_refs cannot be written.
+	void ResetPeakRss()
+	{
+		std::ofstream clearRefs("/proc/self/clear_refs");
+		clearRefs << "5";
+	}
+
+	/// @brief Gets the peak resident set size of the process since the last ResetPeakRss.
+	/// @return The peak resident set size in kilobytes, from VmHWM of /proc/self/status, or the peak of the whole
+	/// process where that cannot be read.
+	long PeakRssKb()
+	{
+		std::ifstream status("/proc/self/status");
+		std::string line;
+		while (std::getline(status, line))
+			if (line.compare(0, 6, "VmHWM:") == 0)
+				return std::stol(line.substr(6));
+
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		return usage.ru_maxrss;
+	}
+
+	/// @brief Gets the current resident set size of the process.
+	/// @return The resident set size in kilobytes, or 0 if /proc/self/statm cannot be read.
+	long CurrentRssKb()
+	{
+		std::ifstream statm("/proc/self/statm");
+		long totalPages = 0, residentPages = 0;
+		if (!(statm >> totalPages >> residentPages))
+			return 0;
+		return residentPages * (sysconf(_SC_PAGESIZE) / 1024);
+	}
+
+	/// @brief Times a run of operations, counting the nodes visited by one operation out of every 64.
+	/// The counting is done outside of the timed sections, before the operation it stands for.
+	/// @param operations The amount of operations to run.
+	/// @param operation Runs the operation at the given index.
+	/// @param visits Counts the nodes the operation at the given index will visit.
+	/// @return The timing and cost of the operations.
+	template <typename Operation, typename Visits>
+	BenchmarkResult Measure(size_t operations, Operation operation, Visits visits)
+	{
+		const size_t SAMPLE_STRIDE = 64;
+
+		ResetPeakRss();
+		Clock::duration elapsed{ };
+		double visited = 0;
+		size_t samples = 0;
+
+		for (size_t begin = 0; begin < operations; begin += SAMPLE_STRIDE)
+		{
+			visited += visits(begin);
+			++samples;
+
+			size_t end = std::min(begin + SAMPLE_STRIDE, operations);
+			Clock::time_point start = Clock::now();
+			for (size_t i = begin; i < end; ++i)
+				operation(i);
+			elapsed += Clock::now() - start;
+		}
+
+		double totalNs = std::chrono::duration<double, std::nano>(elapsed).count();
+		return { totalNs / std::max<size_t>(operations, 1), visited / std::max<size_t>(samples, 1), PeakRssKb(), CurrentRssKb() };
+	}
+
+	/// @brief Counts the nodes a search for a key visits.
+	/// @tparam TreeType The type of tree to use.
+	/// @param a_tree The tree to search.
+	/// @param key The key to search for.
+	/// @return The amount of nodes visited.
+	template <typename TreeType>
+	double FindVisits(const TreeType& a_tree, std::string_view key)
+	{
+		return a_tree.findRecursionCount(key) + (a_tree.contains(key) ? 1 : 0);
+	}
+
+	/// @brief Counts the nodes a removal of a key visits, including the walk to the successor.
+	/// @tparam TreeType The type of tree to use.
+	/// @param a_tree The tree to remove from.
+	/// @param key The key to remove.
+	/// @return The amount of nodes visited.
+	template <typename TreeType>
+	double RemoveVisits(const TreeType& a_tree, std::string_view key)
+	{
+		return a_tree.contains(key) ? a_tree.removeRecursionCount(key) + 1 : a_tree.findRecursionCount(key);
+	}
+
+	/// @brief Prints one row of the results table.
+	/// @param name The name of the benchmark.
+	/// @param scale The amount of keys the benchmark ran with.
+	/// @param result The timing and cost of the benchmark.
+	void PrintResult(const std::string& name, size_t scale, const BenchmarkResult& result)
+	{
+		std::printf("%-24s %10zu %12.1f %12.2f %12ld %10ld\n", name.c_str(), scale, result.nsPerOp, result.nodesPerOp,
+			result.peakRssKb, result.rssKb);
+		std::fflush(stdout);
+	}
+
+	/// @brief Runs the insert, find, remove and mixed workloads on a tree of scale keys.
+	/// insert: builds the tree. find: one lookup per key, alternating hits and misses.
+	/// remove: removes every other key in a random order. mixed: 50% finds, 25% inserts of new keys, 25% removes.
+	/// @tparam TreeType The type of tree to use.
+	/// @param distribution One of random, sorted or rebase.
+	/// @param scale The amount of keys.
+	/// @param rebaseSequences The recognition sequences the rebase keys are derived from.
+	template <typename TreeType>
+	void BenchmarkWorkloads(const std::string& distribution, size_t scale, const std::vector<std::string>& rebaseSequences)
+	{
+		std::vector<std::string> keys = GenerateKeys(distribution, scale, 0, rebaseSequences);
+		std::vector<std::string> newKeys = GenerateKeys(distribution, scale, 1, rebaseSequences);
+		std::mt19937_64 rng(scale);
+
+		TreeType a_tree;
+		PrintResult("insert/" + distribution, scale, Measure(scale,
+			[&](size_t i) { a_tree.insert(SequenceMap(keys[i], "BM")); },
+			[&](size_t i) { return FindVisits(a_tree, keys[i]); }));
+
+		std::vector<std::string> queries;
+		queries.reserve(scale);
+		for (size_t i = 0; i < scale; ++i)
+			queries.push_back(i % 2 == 0 ? keys[rng() % scale] : newKeys[i]);
+
+		size_t found = 0;
+		PrintResult("find/" + distribution, scale, Measure(scale,
+			[&](size_t i) { found += a_tree.find(std::string_view(queries[i])) != nullptr; },
+			[&](size_t i) { return FindVisits(a_tree, queries[i]); }));
+
+		std::vector<std::string> removals;
+		removals.reserve(scale / 2);
+		for (size_t i = 0; i < scale; i += 2)
+			removals.push_back(keys[i]);
+		std::shuffle(removals.begin(), removals.end(), rng);
+
+		TreeType removeTree = a_tree;
+		PrintResult("remove/" + distribution, removals.size(), Measure(removals.size(),
+			[&](size_t i) { removeTree.remove(std::string_view(removals[i])); },
+			[&](size_t i) { return RemoveVisits(removeTree, removals[i]); }));
+		removeTree.makeEmpty();
+
+		// Each mixed operation is a find, insert or remove of a key picked up front.
+		std::vector<int> kinds(scale);
+		std::vector<const std::string*> operands(scale);
+		for (size_t i = 0; i < scale; ++i)
+		{
+			kinds[i] = rng() % 4;
+			operands[i] = kinds[i] == 2 ? &newKeys[i] : &keys[rng() % scale];
+		}
+
+		PrintResult("mixed/" + distribution, scale, Measure(scale,
+			[&](size_t i)
+			{
+				if (kinds[i] < 2)
+					found += a_tree.contains(std::string_view(*operands[i]));
+				else if (kinds[i] == 2)
+					a_tree.insert(SequenceMap(*operands[i], "BM"));
+				else
+					a_tree.remove(std::string_view(*operands[i]));
+			},
+			[&](size_t i) { return kinds[i] == 3 ? RemoveVisits(a_tree, *operands[i]) : FindVisits(a_tree, *operands[i]); }));
+
+		// Keeps the lookups from being optimized away.
+		if (found == size_t(-1))
+			std::cout << found << std::endl;
+	}
+
+	/// @brief Times step 5 of test_tree, looking up and removing every other sequence, on fresh copies of a tree.
+	/// Each copy is made right before its repetition, outside of the timed sections, so only one copy is alive at a time.
+	/// @tparam TreeType The type of tree to use.
+	/// @param full_tree The tree to copy before every repetition.
+	/// @param sequences The sequences to remove every other one of.
+	/// @param repetitions The amount of times to run the workload.
+	template <typename TreeType>
+	void BenchmarkRemoveEveryOther(const TreeType& full_tree, const std::vector<std::string>& sequences, int repetitions)
+	{
+		size_t calls = (sequences.size() + 1) / 2;
+		int successCount = 0;
+		BenchmarkResult result{ 0, 0, 0, 0 };
+
+		for (int repetition = 0; repetition < repetitions; ++repetition)
+		{
+			TreeType a_tree = full_tree;
+			BenchmarkResult run = Measure(calls,
+				[&](size_t i)
+				{
+					std::string_view curr(sequences[i * 2]);
+					successCount += a_tree.contains(curr);
+					a_tree.remove(curr);
+				},
+				[&](size_t i) { return RemoveVisits(a_tree, sequences[i * 2]); });
+
+			result.nsPerOp += run.nsPerOp / repetitions;
+			result.nodesPerOp += run.nodesPerOp / repetitions;
+			result.peakRssKb = std::max(result.peakRssKb, run.peakRssKb);
+		}
+
+		result.rssKb = CurrentRssKb();
+		PrintResult("part5/rebase", successCount / std::max(repetitions, 1), result);
+	}
+
+	/// @brief Runs every workload and key distribution at scales from 1k up to max_scale, then the test_tree step 5 workload.
+	/// @tparam TreeType The type of tree to use.
+	/// @param header The header the tree type comes from, for the report.
+	/// @param db_filename The REBASE database file.
+	/// @param seq_filename The sequences file of test_tree.
+	/// @param max_scale The largest amount of keys to run with.
+	template <typename TreeType>
+	void RunBenchmarks(const std::string& header, const std::string& db_filename, const std::string& seq_filename, size_t max_scale)
+	{
+		std::vector<std::string> rebaseSequences = ReadRecognitionSequences(db_filename);
+
+		std::cout << "tree: " << header << std::endl;
+		std::printf("%-24s %10s %12s %12s %12s %10s\n", "benchmark", "scale", "ns/op", "nodes/op", "peak_rss_kb", "rss_kb");
+
+		for (const std::string distribution : { "random", "sorted", "rebase" })
+			for (size_t scale = 1000; scale <= max_scale; scale *= 10)
+				BenchmarkWorkloads<TreeType>(distribution, scale, rebaseSequences);
+
+		TreeType a_tree;
+		ReadDatabase(db_filename, a_tree);
+
+		std::vector<std::string> sequences;
+		std::ifstream seqFile(seq_filename);
+		std::string sequence;
+		while (seqFile >> sequence)
+			sequences.push_back(sequence);
+		seqFile.close();
+
+		BenchmarkRemoveEveryOther(a_tree, sequences, 200);
+	}
+}  // namespace
@@ -0,0 +1,24 @@
+// benchmark_tree_mod.cc: Benchmark suite for the AvlTree of avl_tree_p2c.h.
+
+#include "avl_tree_p2c.h"
+#include "sequence_map.h"
+#include "benchmark_tree.h"
+
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv)
+{
+	if (argc != 3 && argc != 4)
+	{
+		std::cout << "Usage: " << argv[0] << " <databasefilename> <queryfilename> [max_scale]" << std::endl;
+		return 0;
+	}
+	const std::string db_filename(argv[1]);
+	const std::string seq_filename(argv[2]);
+	const size_t max_scale = argc == 4 ? std::stoul(argv[3]) : 100000;
+
+	RunBenchmarks<AvlTree<SequenceMap>>("avl_tree_p2c.h", db_filename, seq_filename, max_scale);
+
+	return 0;
+}
@@ -5,20 +5,29 @@
 #include "avl_tree.h"
 #include "sequence_map.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <fstream>
+#include <thread>
 #include <vector>
 
 namespace
 {
 
-	/// @brief Reads a file, inserts the data into an AVL tree, and then reads input to display all enzymes of a given recognition sequence, else will display Not Found.
+	/// @brief Reads a database file and inserts its SequenceMaps into an AVL tree.
 	/// @tparam TreeType The type of tree to use.
 	/// @param db_filename The name of the file to insert data from.
 	/// @param a_tree The tree to insert the data into.
 	template <typename TreeType>
-	void QueryTree(const std::string& db_filename, TreeType& a_tree)
+	void ReadDatabase(const std::string& db_filename, TreeType& a_tree)
 	{
 		std::ifstream dbFile(db_filename);
 		std::string dbLine;
@@ -59,15 +68,23 @@ namespace
 		}
 
 		dbFile.close();
+	}
+
+	/// @brief Reads a file, inserts the data into an AVL tree, and then reads input to display all enzymes of a given recognition sequence, else will display Not Found.
+	/// @tparam TreeType The type of tree to use.
+	/// @param db_filename The name of the file to insert data from.
+	/// @param a_tree The tree to insert the data into.
+	template <typename TreeType>
+	void QueryTree(const std::string& db_filename, TreeType& a_tree)
+	{
+		ReadDatabase(db_filename, a_tree);
 
 		std::string recognitionSequence;
 
 		// Read in the recognition sequence(s) from the user.
 		while (std::cin >> recognitionSequence)
 		{
-			SequenceMap target(recognitionSequence, "");
-
-			const SequenceMap* result = a_tree.find(target);
+			const SequenceMap* result = a_tree.find(std::string_view(recognitionSequence));
 
 			if (result != nullptr)
 				std::cout << *result << std::endl;
@@ -75,20 +92,169 @@ namespace
 				std::cout << "Not Found" << std::endl;
 		}
 	}
+
+	/// @brief A block of the query stream and the answers still being resolved for it.
+	struct QueryBlock
+	{
+		std::vector<char> text;
+		std::vector<std::string_view> queries;
+		std::vector<std::future<std::string>> answers;
+	};
+
+	/// @brief Checks if a character separates queries, the same characters std::cin >> skips.
+	/// @param c The character to check.
+	/// @return True if the character is whitespace.
+	bool IsSeparator(char c)
+	{
+		return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+	}
+
+	/// @brief Resolves a slice of queries against the tree, formatting the answers like QueryTree.
+	/// @tparam TreeType The type of tree to use.
+	/// @param a_tree The tree to search, only read from.
+	/// @param queries The queries of the block.
+	/// @param begin The index of the first query of the slice.
+	/// @param end One past the index of the last query of the slice.
+	/// @return The answer lines of the slice.
+	template <typename TreeType>
+	std::string ResolveQueries(const TreeType& a_tree, const std::vector<std::string_view>& queries, size_t begin, size_t end)
+	{
+		std::ostringstream answers;
+
+		for (size_t i = begin; i < end; ++i)
+		{
+			const SequenceMap* result = a_tree.find(queries[i]);
+
+			if (result != nullptr)
+				answers << *result << '\n';
+			else
+				answers << "Not Found\n";
+		}
+
+		return answers.str();
+	}
+
+	/// @brief Waits for the answers of a block and writes them out in order.
+	/// @param block The block to write the answers of.
+	void WriteAnswers(QueryBlock& block)
+	{
+		for (auto& pending : block.answers)
+		{
+			const std::string answers = pending.get();
+			std::fwrite(answers.data(), 1, answers.size(), stdout);
+		}
+
+		block.answers.clear();
+	}
+
+	/// @brief Reads an AVL tree from a file, then answers the queries on stdin in large blocks, giving the same output as QueryTree.
+	/// The next block is read while worker threads resolve the current one against the shared tree, and answers are written in input order.
+	/// @tparam TreeType The type of tree to use.
+	/// @param db_filename The name of the file to insert data from.
+	/// @param a_tree The tree to insert the data into.
+	/// @param threads The amount of worker threads to resolve each block with.
+	template <typename TreeType>
+	void BatchQueryTree(const std::string& db_filename, TreeType& a_tree, unsigned threads)
+	{
+		const size_t BLOCK_SIZE = 1 << 20;
+
+		ReadDatabase(db_filename, a_tree);
+
+		QueryBlock blocks[2];
+		std::string carry;
+		size_t queryCount = 0;
+		bool done = false;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		for (int current = 0; !done; current ^= 1)
+		{
+			QueryBlock& block = blocks[current];
+
+			// Read the next block behind the unfinished query left over from the last one.
+			block.text.assign(carry.begin(), carry.end());
+			block.text.resize(carry.size() + BLOCK_SIZE);
+			size_t bytesRead = std::fread(block.text.data() + carry.size(), 1, BLOCK_SIZE, stdin);
+			block.text.resize(carry.size() + bytesRead);
+			done = bytesRead < BLOCK_SIZE;
+
+			// Unless this is the last block, its final query may continue in the next block.
+			size_t end = block.text.size();
+			if (!done)
+				while (end > 0 && !IsSeparator(block.text[end - 1]))
+					--end;
+			carry.assign(block.text.begin() + end, block.text.end());
+
+			block.queries.clear();
+			for (size_t i = 0; i < end; ++i)
+			{
+				if (IsSeparator(block.text[i]))
+					continue;
+
+				size_t length = 1;
+				while (i + length < end && !IsSeparator(block.text[i + length]))
+					++length;
+
+				block.queries.emplace_back(block.text.data() + i, length);
+				i += length;
+			}
+			queryCount += block.queries.size();
+
+			// The previous block has been resolving while this one was read.
+			WriteAnswers(blocks[current ^ 1]);
+
+			size_t sliceSize = (block.queries.size() + threads - 1) / threads;
+			for (size_t begin = 0; begin < block.queries.size(); begin += sliceSize)
+				block.answers.push_back(std::async(std::launch::async, ResolveQueries<TreeType>, std::cref(a_tree),
+					std::cref(block.queries), begin, std::min(begin + sliceSize, block.queries.size())));
+		}
+
+		WriteAnswers(blocks[0]);
+		WriteAnswers(blocks[1]);
+		std::fflush(stdout);
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		std::cerr << "queries: " << queryCount << std::endl;
+		std::cerr << "seconds: " << seconds << std::endl;
+		std::cerr << "queries_per_second: " << queryCount / seconds << std::endl;
+	}
 }
 
 int main(int argc, char** argv)
 {
-	if (argc != 2)
+	if (argc < 2 || argc > 4 || (argc > 2 && std::string(argv[2]) != "batch"))
 	{
 		cout << "Usage: " << argv[0] << " <databasefilename>" << endl;
+		cout << "or Usage: " << argv[0] << " <databasefilename> batch [threads]" << endl;
 		return 0;
 	}
 	const std::string db_filename(argv[1]);
 
 	cout << "Input filename is " << db_filename << endl;
 	AvlTree<SequenceMap> a_tree;
-	QueryTree(db_filename, a_tree);
+
+	if (argc == 2)
+		QueryTree(db_filename, a_tree);
+	else
+	{
+		// More threads than a few per core only add slices, each of which is a thread of its own.
+		unsigned threads = std::max(std::thread::hardware_concurrency(), 1u);
+		unsigned maxThreads = 4 * threads;
+		if (argc == 4)
+		{
+			char* end;
+			errno = 0;
+			unsigned long requested = std::strtoul(argv[3], &end, 10);
+			if (end == argv[3] || *end != '\0' || errno == ERANGE || requested == 0 || argv[3][0] == '-')
+			{
+				cerr << "Invalid thread count " << argv[3] << ", expected a positive integer" << endl;
+				return 1;
+			}
+			threads = static_cast<unsigned>(std::min<unsigned long>(requested, maxThreads));
+		}
+		BatchQueryTree(db_filename, a_tree, threads);
+	}
 
 	return 0;
 }
@@ -3,6 +3,7 @@
 #include<iostream>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <algorithm>
 
 class SequenceMap
@@ -37,6 +38,23 @@ public:
         return recognitionSequence > rhs.recognitionSequence;
     }
 
+    /// @brief Less than comparison against a bare recognition sequence, lets a tree be searched without building a SequenceMap.
+    /// @param rhs The recognition sequence to compare to.
+    /// @return True if the recognition sequence of this SequenceMap is less than the given recognition sequence.
+    bool operator<(std::string_view rhs) const
+    {
+        return recognitionSequence < rhs;
+    }
+
+    /// @brief Less than comparison of a bare recognition sequence against a SequenceMap.
+    /// @param lhs The recognition sequence to compare.
+    /// @param rhs The SequenceMap to compare to.
+    /// @return True if the given recognition sequence is less than the recognition sequence of the SequenceMap.
+    friend bool operator<(std::string_view lhs, const SequenceMap& rhs)
+    {
+        return lhs < rhs.recognitionSequence;
+    }
+
     /// @brief Displays all the enzymes associated with this recognition sequence.
     /// @param out The output stream to display the enzymes to.
     /// @param sequenceMap The SequenceMap to display the enzymes of.
@@ -80,4 +98,14 @@ public:
                 if (std::find(enzymeAcronyms.begin(), enzymeAcronyms.end(), enzymeAcronym) == enzymeAcronyms.end())
                     enzymeAcronyms.push_back(enzymeAcronym);
     }
+
+    /// @brief Same as Merge(const SequenceMap&), but moves the enzyme acronyms of the other SequenceMap instead of copying them.
+    /// @param otherSequence The other SequenceMap to merge with this SequenceMap, left with unspecified enzyme acronyms.
+    void Merge(SequenceMap&& otherSequence)
+    {
+        if (recognitionSequence == otherSequence.recognitionSequence)
+            for (auto& enzymeAcronym : otherSequence.enzymeAcronyms)
+                if (std::find(enzymeAcronyms.begin(), enzymeAcronyms.end(), enzymeAcronym) == enzymeAcronyms.end())
+                    enzymeAcronyms.push_back(std::move(enzymeAcronym));
+    }
 };
\ No newline at end of file
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "sequence_map.h"
+
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	/// @brief Gets the enzymes a tree holds for a recognition sequence, or an empty string if it has none.
+	/// @tparam TreeType The type of tree to use.
+	/// @param a_tree The tree to search.
+	/// @param key The recognition sequence.
+	/// @return The enzymes, as printed by SequenceMap.
+	template <typename TreeType>
+	std::string EnzymesOf(const TreeType& a_tree, const std::string& key)
+	{
+		const SequenceMap* found = a_tree.find(std::string_view(key));
+		if (found == nullptr)
+			return "";
+
+		std::ostringstream out;
+		out << *found;
+		return out.str();
+	}
+
+	/// @brief Checks that a tree is balanced and holds the same nodes, with the same enzymes, as a reference tree.
+	/// @tparam TreeType The type of tree to use.
+	/// @param name The operation that built the tree, for the report.
+	/// @param actual The tree to check.
+	/// @param expected The reference tree.
+	/// @param keys Every recognition sequence either tree may hold.
+	/// @return True if the trees match, false otherwise.
+	template <typename TreeType>
+	bool SameTree(const std::string& name, const TreeType& actual, const TreeType& expected, const std::vector<std::string>& keys)
+	{
+		bool same = actual.isBalanced() && actual.count() == expected.count();
+		for (size_t i = 0; same && i < keys.size(); ++i)
+			same = EnzymesOf(actual, keys[i]) == EnzymesOf(expected, keys[i]);
+
+		if (!same)
+			std::cout << "set operations: " << name << " does not match " << expected.count() << " nodes" << std::endl;
+
+		return same;
+	}
+
+	/// @brief Compares unionWith, intersectionWith, differenceWith and split on two random trees with the same
+	/// operations done one insert or remove at a time, and checks operations of a tree with itself.
+	/// @tparam TreeType The type of tree to use.
+	/// @param size The number of nodes of each random tree.
+	/// @param threads The threads the operations may spread over, more than one to run the parallel path.
+	/// @param rng The random numbers to build the trees from.
+	/// @return True if every operation matches, false otherwise.
+	template <typename TreeType>
+	bool TestSetOperations(size_t size, unsigned threads, std::mt19937& rng)
+	{
+		// Draw both trees from twice as many keys, so about half of each tree is also in the other.
+		std::vector<std::string> keys;
+		for (size_t i = 0; i < 2 * size + 1; ++i)
+		{
+			std::string key(12, 'A');
+			for (auto& base : key)
+				base = "ACGT"[rng() % 4];
+			keys.push_back(key);
+		}
+
+		TreeType a, b;
+		for (size_t i = 0; i < size; ++i)
+		{
+			a.insert(SequenceMap(keys[rng() % keys.size()], "a" + std::to_string(i)));
+			b.insert(SequenceMap(keys[rng() % keys.size()], "b" + std::to_string(i)));
+		}
+
+		bool passed = a.isBalanced() && b.isBalanced();
+
+		// Union: insert every node of b into a copy of a.
+		TreeType expected = a;
+		for (auto& key : keys)
+			if (b.contains(std::string_view(key)))
+				expected.insert(*b.find(std::string_view(key)));
+		TreeType actual = a;
+		actual.unionWith(b, threads);
+		passed &= SameTree("unionWith", actual, expected, keys);
+
+		// Intersection: remove every node of a copy of a that b lacks, and merge the rest.
+		expected = a;
+		for (auto& key : keys)
+		{
+			if (!b.contains(std::string_view(key)))
+				expected.remove(std::string_view(key));
+			else if (expected.contains(std::string_view(key)))
+				expected.insert(*b.find(std::string_view(key)));
+		}
+		actual = a;
+		actual.intersectionWith(TreeType{ b }, threads);
+		passed &= SameTree("intersectionWith", actual, expected, keys);
+
+		// Difference: remove every node of b from a copy of a.
+		expected = a;
+		for (auto& key : keys)
+			if (b.contains(std::string_view(key)))
+				expected.remove(std::string_view(key));
+		actual = a;
+		actual.differenceWith(b, threads);
+		passed &= SameTree("differenceWith", actual, expected, keys);
+
+		// Split around a key that may or may not be in a.
+		const std::string& pivot = keys[rng() % keys.size()];
+		TreeType lesser, greater, expectedLesser, expectedGreater;
+		for (auto& key : keys)
+		{
+			if (!a.contains(std::string_view(key)))
+				continue;
+			if (key < pivot)
+				expectedLesser.insert(*a.find(std::string_view(key)));
+			else if (pivot < key)
+				expectedGreater.insert(*a.find(std::string_view(key)));
+		}
+		actual = a;
+		passed &= actual.split(SequenceMap(pivot, ""), lesser, greater) == a.contains(std::string_view(pivot));
+		passed &= actual.count() == (a.contains(std::string_view(pivot)) ? 1 : 0);
+		passed &= SameTree("split lesser", lesser, expectedLesser, keys);
+		passed &= SameTree("split greater", greater, expectedGreater, keys);
+
+		// Operations of a tree with itself.
+		actual = a;
+		actual.unionWith(actual, threads);
+		passed &= SameTree("unionWith itself", actual, a, keys);
+		actual.unionWith(std::move(actual), threads);
+		passed &= SameTree("unionWith moved itself", actual, a, keys);
+		actual.intersectionWith(actual, threads);
+		passed &= SameTree("intersectionWith itself", actual, a, keys);
+		actual.intersectionWith(std::move(actual), threads);
+		passed &= SameTree("intersectionWith moved itself", actual, a, keys);
+		actual.differenceWith(actual, threads);
+		passed &= SameTree("differenceWith itself", actual, TreeType{ }, keys);
+		actual = a;
+		actual.differenceWith(std::move(actual), threads);
+		passed &= SameTree("differenceWith moved itself", actual, TreeType{ }, keys);
+
+		return passed;
+	}
+
+	/// @brief Runs the set operation tests at sizes from a handful of nodes to trees tall enough to fork, with one
+	/// thread and with several.
+	/// @tparam TreeType The type of tree to use.
+	/// @return True if every test passed, false otherwise.
+	template <typename TreeType>
+	bool TestSetOperations()
+	{
+		std::mt19937 rng(335);
+		bool passed = true;
+
+		for (size_t size : { 0, 1, 2, 10, 100, 1000, 20000 })
+			for (unsigned threads : { 1u, 8u })
+				passed &= TestSetOperations<TreeType>(size, threads, rng);
+
+		std::cout << "set operations: " << (passed ? "passed" : "FAILED") << std::endl;
+		return passed;
+	}
+}  // namespace
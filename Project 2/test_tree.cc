@@ -4,9 +4,11 @@
 
 #include "avl_tree.h"
 #include "sequence_map.h"
+#include "set_operations_test.h"
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <fstream>
 using namespace std;
 
@@ -74,7 +76,7 @@ namespace
 		while (seqFile >> dbLine)
 		{
 			++sequenceCount;
-			SequenceMap curr(dbLine, "");
+			std::string_view curr(dbLine);
 			successCount += a_tree.contains(curr);
 			recursionCount += a_tree.findRecursionCount(curr);
 		}
@@ -99,7 +101,7 @@ namespace
 				continue;
 			}
 
-			SequenceMap curr(dbLine, "");
+			std::string_view curr(dbLine);
 			bool contains = a_tree.contains(curr);
 			successCount += contains;
 			recursionCount += contains ? a_tree.removeRecursionCount(curr) : 0;
@@ -117,9 +119,9 @@ namespace
 
 int main(int argc, char** argv)
 {
-	if (argc != 3)
+	if (argc != 3 && !(argc == 4 && string(argv[3]) == "sets"))
 	{
-		cout << "Usage: " << argv[0] << " <databasefilename> <queryfilename>" << endl;
+		cout << "Usage: " << argv[0] << " <databasefilename> <queryfilename> [sets]" << endl;
 		return 0;
 	}
 	const string db_filename(argv[1]);
@@ -130,5 +132,9 @@ int main(int argc, char** argv)
 	AvlTree<SequenceMap> a_tree;
 	TestTree(db_filename, seq_filename, a_tree);
 
+	// Also check the set operations against the same operations done one node at a time.
+	if (argc == 4)
+		return TestSetOperations<AvlTree<SequenceMap>>() ? 0 : 1;
+
 	return 0;
 }
@@ -0,0 +1,1148 @@
+// benchmark_hash.cc: Benchmarks for the hash tables.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <malloc.h>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+
+#include "linear_probing.h"
+#include "quadratic_probing.h"
+#include "bk_tree.h"
+#include "bloom_filter.h"
+#include "concurrent_hash_set.h"
+#include "deletion_index.h"
+#include "document_tokenizer.h"
+#include "double_hashing.h"
+#include "perfect_hash.h"
+#include "robin_hood_hashing.h"
+#include "spell_pipeline.h"
+#include "suggestion_cache.h"
+#include "swiss_table.h"
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+/// @brief Reads every word of a file.
+/// @param words_filename The file to read.
+/// @return The words, in file order.
+vector<string> ReadWords(const string& words_filename)
+{
+    vector<string> words;
+    ifstream wordsFile(words_filename);
+    string line;
+
+    while (wordsFile >> line)
+        words.push_back(line);
+
+    return words;
+}
+
+/// @brief Averages the probes of searches for some words.
+/// @tparam HashTableType The type of hash table to search.
+/// @param hash_table The hash table to search.
+/// @param words The words to search for, at most the first 2000 are used.
+/// @return The average number of probes.
+template <typename HashTableType>
+double AverageProbes(const HashTableType& hash_table, const vector<string>& words)
+{
+    size_t count = min<size_t>(words.size(), 2000);
+    size_t probes = 0;
+
+    for (size_t i = 0; i < count; ++i)
+        probes += hash_table.GetProbes(words[i]);
+
+    return count == 0 ? 0 : (double)probes / count;
+}
+
+/// @brief Churn benchmark: half of the words stay in the table while every round swaps 10% of them
+/// for words that are not in it, by removing one and inserting another. Prints the probes of searches
+/// that hit and miss as the table ages, and the bytes of the key buffer of an ArenaLayout table. Rehashes drop the
+/// characters of removed keys, so the buffer is flagged as GROWING past twice the length of every word together.
+/// @tparam HashTableType The type of hash table to test.
+/// @param name The name of the hash table, for the report.
+/// @param words The words to churn through.
+/// @param rounds The amount of rounds to run.
+template <typename HashTableType>
+void ChurnBenchmark(const string& name, const vector<string>& words, size_t rounds)
+{
+    vector<string> live(words.begin(), words.begin() + words.size() / 2);
+    vector<string> spare(words.begin() + words.size() / 2, words.end());
+    size_t batch = live.size() / 10;
+    size_t word_bytes = 0;
+    for (auto& word : words)
+        word_bytes += word.size();
+
+    HashTableType hash_table;
+    for (auto& word : live)
+        hash_table.Insert(word);
+
+    mt19937 rng(335);
+    Clock::duration elapsed{ };
+    size_t operations = 0;
+
+    for (size_t round = 1; round <= rounds; ++round)
+    {
+        Clock::time_point start = Clock::now();
+        for (size_t k = 0; k < batch; ++k)
+        {
+            size_t i = rng() % live.size();
+            size_t j = rng() % spare.size();
+
+            hash_table.Remove(live[i]);
+            hash_table.Insert(spare[j]);
+            swap(live[i], spare[j]);
+        }
+        elapsed += Clock::now() - start;
+        operations += 2 * batch;
+
+        if (round % max<size_t>(rounds / 10, 1) == 0)
+        {
+            double ns = chrono::duration<double, nano>(elapsed).count() / operations;
+            printf("%-12s %8zu %10zu %12.2f %12.2f %12zu %10.1f %10zu%s\n", name.c_str(), round, hash_table.GetCapacity(),
+                AverageProbes(hash_table, live), AverageProbes(hash_table, spare), hash_table.GetTotalCollisions(), ns,
+                hash_table.GetKeyBytes() / 1024, hash_table.GetKeyBytes() > 2 * word_bytes ? " GROWING" : "");
+        }
+    }
+}
+
+/// @brief Latency benchmark: inserts every word into an empty table, timing each insert on its own.
+/// Prints the percentiles of the insert latencies and a histogram of them in power of two buckets,
+/// so the inserts that rehash the whole table stand out from the rest.
+/// @tparam HashTableType The type of hash table to test.
+/// @param name The name of the hash table, for the report.
+/// @param hash_table The empty hash table to insert into, already configured.
+/// @param words The words to insert.
+/// @param histogram Adds the amount of inserts that took at most 2^i nanoseconds to entry i.
+template <typename HashTableType>
+void LatencyBenchmark(const string& name, HashTableType& hash_table, const vector<string>& words, vector<size_t>& histogram)
+{
+    vector<double> latencies;
+    latencies.reserve(words.size());
+
+    for (auto& word : words)
+    {
+        Clock::time_point start = Clock::now();
+        hash_table.Insert(word);
+        latencies.push_back(chrono::duration<double, nano>(Clock::now() - start).count());
+    }
+
+    for (double ns : latencies)
+    {
+        size_t bucket = 0;
+        while (bucket + 1 < histogram.size() && ns > (double)(1ull << bucket))
+            ++bucket;
+        ++histogram[bucket];
+    }
+
+    sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) { return latencies[min(latencies.size() - 1, (size_t)(p * latencies.size()))]; };
+    printf("%-22s %10zu %10.0f %10.0f %10.0f %12.0f\n", name.c_str(), hash_table.GetCapacity(),
+        percentile(0.5), percentile(0.99), percentile(0.999), latencies.back());
+}
+
+/// @brief Times searches for every word and for every word with a character changed, which mostly miss.
+/// Prints the time per search of both.
+/// @tparam HashTableType The type of hash table to test.
+/// @param name The name of the hash table, for the report.
+/// @param hash_table The hash table to search, holding the words.
+/// @param words The words to search for.
+/// @param rounds The amount of times to search for every word.
+template <typename HashTableType>
+void SearchBenchmark(const string& name, HashTableType& hash_table, const vector<string>& words, size_t rounds)
+{
+    vector<string> misses(words);
+    for (auto& word : misses)
+        word.back() = word.back() == 'z' ? 'a' : word.back() + 1;
+
+    size_t found = 0;
+    Clock::time_point start = Clock::now();
+    for (size_t round = 0; round < rounds; ++round)
+        for (auto& word : words)
+            found += hash_table.Contains(word);
+    Clock::time_point middle = Clock::now();
+    for (size_t round = 0; round < rounds; ++round)
+        for (auto& word : misses)
+            found += hash_table.Contains(word);
+    Clock::time_point end = Clock::now();
+
+    double searches = (double)rounds * words.size();
+    printf("%-20s %10zu %12.1f %12.1f %10zu\n", name.c_str(), hash_table.GetCapacity(),
+        chrono::duration<double, nano>(middle - start).count() / searches,
+        chrono::duration<double, nano>(end - middle).count() / searches, found);
+}
+
+/// @brief Lookup benchmark: inserts every word, then runs the search benchmark.
+/// @tparam HashTableType The type of hash table to test.
+/// @param name The name of the hash table, for the report.
+/// @param hash_table The empty hash table to insert into, already configured.
+/// @param words The words to insert and search for.
+/// @param rounds The amount of times to search for every word.
+template <typename HashTableType>
+void LookupBenchmark(const string& name, HashTableType& hash_table, const vector<string>& words, size_t rounds)
+{
+    for (auto& word : words)
+        hash_table.Insert(word);
+
+    SearchBenchmark(name, hash_table, words, rounds);
+}
+
+/// @brief Sets the R value of a double hashing table, other tables have none.
+template <typename HashTableType>
+void SetRValueIfDouble(HashTableType&, int)
+{ }
+
+template <typename CapacityPolicy, typename Layout>
+void SetRValueIfDouble(HashTableDouble<string, CapacityPolicy, Layout>& hash_table, int R)
+{
+    hash_table.SetRValue(R);
+}
+
+/// @brief Drain benchmark: inserts every word, then removes all but 1% of them, with and without shrinking. Prints the
+/// capacity at the peak and once drained, the tombstones left, and the probes of searches that hit and miss.
+/// @tparam HashTableType The type of hash table to test.
+/// @param name The name of the hash table, for the report.
+/// @param words The words to insert and remove.
+template <typename HashTableType>
+void DrainBenchmark(const string& name, const vector<string>& words)
+{
+    size_t kept = words.size() / 100;
+    vector<string> live(words.end() - kept, words.end());
+    vector<string> removed(words.begin(), words.begin() + kept);
+
+    for (bool shrink : { false, true })
+    {
+        HashTableType hash_table;
+        SetRValueIfDouble(hash_table, 89);
+        if (!shrink)
+            hash_table.SetMinLoadFactor(0);
+
+        for (auto& word : words)
+            hash_table.Insert(word);
+        size_t peak = hash_table.GetCapacity();
+
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i + kept < words.size(); ++i)
+            hash_table.Remove(words[i]);
+        double ns = chrono::duration<double, nano>(Clock::now() - start).count() / (words.size() - kept);
+
+        printf("%-18s %10zu %10zu %10zu %12.2f %12.2f %10.1f\n", (name + (shrink ? "/shrink" : "")).c_str(), peak,
+            hash_table.GetCapacity(), hash_table.GetTombstoneCount(), AverageProbes(hash_table, live),
+            AverageProbes(hash_table, removed), ns);
+    }
+}
+
+/// @brief Runs the latency benchmark for a type of hash table, rehashing all at once and incrementally.
+/// @tparam HashTableType The type of hash table to test.
+/// @param name The name of the hash table, for the report.
+/// @param words The words to insert.
+/// @param R The R value of double hashing, unused by other tables.
+/// @param histograms The histograms of every run so far, the two runs add their own.
+template <typename HashTableType>
+void LatencyPair(const string& name, const vector<string>& words, int R, vector<vector<size_t>>& histograms)
+{
+    for (bool incremental : { false, true })
+    {
+        HashTableType hash_table;
+        SetRValueIfDouble(hash_table, R);
+        hash_table.SetIncrementalRehash(incremental);
+
+        histograms.emplace_back(32, 0);
+        LatencyBenchmark(name + (incremental ? "/incremental" : "/stop"), hash_table, words, histograms.back());
+    }
+}
+
+/// @brief Runs the lookup benchmark for a type of hash table with each capacity policy.
+/// @tparam HashTableType The type of hash table to test, without its capacity policy.
+/// @param name The name of the hash table, for the report.
+/// @param words The words to insert and search for.
+/// @param rounds The amount of times to search for every word.
+/// @param R The R value of double hashing, unused by other tables.
+template <template <typename, typename> class HashTableType>
+void CapacityBenchmark(const string& name, const vector<string>& words, size_t rounds, int R)
+{
+    HashTableType<string, PrimeCapacity> prime_table;
+    HashTableType<string, PowerOfTwoCapacity> mask_table;
+    HashTableType<string, FastRangeCapacity> fastrange_table;
+    SetRValueIfDouble(prime_table, R);
+    SetRValueIfDouble(mask_table, R);
+    SetRValueIfDouble(fastrange_table, R);
+
+    LookupBenchmark(name + "/prime", prime_table, words, rounds);
+    LookupBenchmark(name + "/mask", mask_table, words, rounds);
+    LookupBenchmark(name + "/fastrange", fastrange_table, words, rounds);
+}
+
+/// @brief Load benchmark: fills a table with every word at a max load factor, growing as it goes or reserved up
+/// front, then searches for every word. Prints the capacity, the rehashes, the time to fill the table, and the
+/// probes and time of the searches. Skips load factors the table does not allow.
+/// @tparam HashTableType The type of hash table to test.
+/// @param name The name of the hash table, for the report.
+/// @param words The words to insert and search for.
+/// @param load_factor The max load factor.
+/// @param reserve True to reserve room for every word first, false to grow as the words come.
+template <typename HashTableType>
+void LoadBenchmark(const string& name, const vector<string>& words, double load_factor, bool reserve)
+{
+    HashTableType hash_table;
+    SetRValueIfDouble(hash_table, 89);
+    hash_table.SetMaxLoadFactor(load_factor);
+    if (hash_table.GetMaxLoadFactor() != load_factor)
+        return;
+
+    Clock::time_point start = Clock::now();
+    if (reserve)
+        hash_table.Reserve(words.size());
+    for (auto& word : words)
+        hash_table.Insert(word);
+    Clock::time_point middle = Clock::now();
+
+    size_t found = 0;
+    for (auto& word : words)
+        found += hash_table.Contains(word);
+    Clock::time_point end = Clock::now();
+
+    size_t probes = 0;
+    for (auto& word : words)
+        probes += hash_table.GetProbes(word);
+
+    printf("%-10s %6.3f %8s %10zu %9zu %10.2f %10.3f %10.1f\n", name.c_str(), load_factor, reserve ? "reserve" : "grow",
+        hash_table.GetCapacity(), hash_table.GetRehashCount(), chrono::duration<double, milli>(middle - start).count(),
+        (double)probes / words.size(), chrono::duration<double, nano>(end - middle).count() / words.size());
+}
+
+/// @brief Gets the bytes of the heap that are handed out and not freed yet.
+/// @return The bytes in use.
+size_t HeapInUse()
+{
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+/// @brief Arena benchmark: fills a double hashing table with every word, sized for them up front, then times
+/// searches for every word, passed both as std::string and as std::string_view into one buffer of all the words.
+/// Prints the time to fill the table, the heap it holds, and the time per search of both.
+/// @tparam Layout The layout of the table.
+/// @param name The name of the layout, for the report.
+/// @param words The words to insert and search for.
+/// @param rounds The amount of times to search for every word.
+template <typename Layout>
+void ArenaBenchmark(const string& name, const vector<string>& words, size_t rounds)
+{
+    string text;
+    vector<string_view> views;
+    for (auto& word : words)
+        text += word;
+    views.reserve(words.size());
+    for (size_t i = 0, offset = 0; i < words.size(); offset += words[i++].size())
+        views.emplace_back(text.data() + offset, words[i].size());
+
+    size_t heap = HeapInUse();
+    Clock::time_point start = Clock::now();
+    HashTableDouble<string, PrimeCapacity, Layout> hash_table;
+    hash_table.SetRValue(89);
+    hash_table.Reserve(words.size());
+    hash_table.ReserveKeys(text.size());
+    for (auto& word : words)
+        hash_table.Insert(word);
+    Clock::time_point middle = Clock::now();
+    heap = HeapInUse() - heap;
+
+    size_t found = 0;
+    for (size_t round = 0; round < rounds; ++round)
+        for (auto& word : words)
+            found += hash_table.Contains(word);
+    Clock::time_point views_start = Clock::now();
+    for (size_t round = 0; round < rounds; ++round)
+        for (auto& view : views)
+            found += hash_table.Contains(view);
+    Clock::time_point end = Clock::now();
+
+    double searches = (double)rounds * words.size();
+    printf("%-10s %10zu %10.2f %10zu %12.1f %10.1f %10.1f %10zu\n", name.c_str(), hash_table.GetCapacity(),
+        chrono::duration<double, milli>(middle - start).count(), heap / 1024, (double)heap / words.size(),
+        chrono::duration<double, nano>(views_start - middle).count() / searches,
+        chrono::duration<double, nano>(end - views_start).count() / searches, found);
+}
+
+/// @brief Perfect hash benchmark: builds a PerfectHashDictionary from every word, saves its image and maps it back,
+/// then times searches for every word and for every word with a character changed, on the mapped dictionary and on
+/// double hashing tables of the inline and arena layouts. Prints the build and load times, the bytes the dictionary
+/// takes, and the probes and time per search.
+/// @param words The words to build from and search for.
+/// @param image_filename The file to save the image to.
+/// @param rounds The amount of times to search for every word.
+void PerfectBenchmark(const vector<string>& words, const string& image_filename, size_t rounds)
+{
+    Clock::time_point start = Clock::now();
+    PerfectHashDictionary built;
+    if (!built.Build(words) || !built.Save(image_filename))
+    {
+        cout << "Could not build and save " << image_filename << endl;
+        return;
+    }
+    Clock::time_point middle = Clock::now();
+    PerfectHashDictionary perfect;
+    perfect.Load(image_filename);
+    Clock::time_point end = Clock::now();
+    printf("build %.2f ms, load %.3f ms, image %zu bytes (%.1f per word)\n\n",
+        chrono::duration<double, milli>(middle - start).count(), chrono::duration<double, milli>(end - middle).count(),
+        perfect.GetImageSize(), (double)perfect.GetImageSize() / perfect.GetCapacity());
+
+    HashTableDouble<string> inline_table;
+    HashTableDouble<string, PrimeCapacity, ArenaLayout> arena_table;
+    inline_table.SetRValue(89);
+    arena_table.SetRValue(89);
+
+    printf("%-20s %10s %12s %12s %10s\n", "table", "capacity", "hit_ns", "miss_ns", "found");
+    LookupBenchmark("double/inline", inline_table, words, rounds);
+    LookupBenchmark("double/arena", arena_table, words, rounds);
+    SearchBenchmark("perfect", perfect, words, rounds);
+    printf("\n%-20s %12s\n", "table", "hit_probes");
+    printf("%-20s %12.3f\n", "double/inline", AverageProbes(inline_table, words));
+    printf("%-20s %12.3f\n", "perfect", AverageProbes(perfect, words));
+}
+
+/// @brief Finds the words of a document that are not in a dictionary, cleaned up as the spell checker does.
+/// @param dictionary The dictionary.
+/// @param document_filename The document to check.
+/// @return The misspelled words, in document order.
+vector<string> ReadMisspelled(HashTableDouble<string>& dictionary, const string& document_filename)
+{
+    vector<string> misspelled;
+    for (string word : ReadWords(document_filename))
+    {
+        transform(word.begin(), word.end(), word.begin(), [](unsigned char c) { return tolower(c); });
+        if (!word.empty() && !isalnum((unsigned char)word.front()))
+            word.erase(0, 1);
+        if (!word.empty() && !isalnum((unsigned char)word.back()))
+            word.pop_back();
+        if (!dictionary.Contains(word))
+            misspelled.push_back(word);
+    }
+
+    return misspelled;
+}
+
+/// @brief Suggest benchmark: times case A of the spell checker for the misspelled words of a document, the letters
+/// that inserted into a word make a dictionary word. Case A runs both by searching the dictionary for every letter
+/// at every position and by one search of a deletion index. Prints the time to build the index, its size, and the
+/// time per misspelled word of both.
+/// @param words The words of the dictionary.
+/// @param document_filename The document to check.
+void SuggestBenchmark(const vector<string>& words, const string& document_filename)
+{
+    const size_t ROUNDS = 20;
+    HashTableDouble<string> dictionary;
+    dictionary.SetRValue(89);
+    dictionary.Reserve(words.size());
+    for (auto& word : words)
+        dictionary.Insert(word);
+
+    Clock::time_point start = Clock::now();
+    DeletionIndex index;
+    index.Build(words);
+    Clock::time_point end = Clock::now();
+    printf("index build %.2f ms, %zu deletions, %zu bytes\n", chrono::duration<double, milli>(end - start).count(),
+        index.GetEntryCount(), index.GetBytes());
+
+    vector<string> misspelled = ReadMisspelled(dictionary, document_filename);
+
+    size_t enumerated = 0;
+    start = Clock::now();
+    for (size_t round = 0; round < ROUNDS; ++round)
+        for (auto& word : misspelled)
+            for (size_t i = 0; i < word.size() + 1; ++i)
+                for (char c = 'a'; c <= 'z'; ++c)
+                {
+                    string temp = word;
+                    temp.insert(i, 1, c);
+                    enumerated += dictionary.Contains(temp);
+                }
+    Clock::time_point middle = Clock::now();
+    size_t indexed = 0;
+    for (size_t round = 0; round < ROUNDS; ++round)
+        for (auto& word : misspelled)
+            indexed += index.Insertions(word).size();
+    end = Clock::now();
+
+    double checks = (double)ROUNDS * misspelled.size();
+    printf("%zu misspelled words\n\n%-12s %12s %12s\n", misspelled.size(), "case A", "us_per_word", "suggestions");
+    printf("%-12s %12.2f %12zu\n", "enumerate", chrono::duration<double, micro>(middle - start).count() / checks, enumerated / ROUNDS);
+    printf("%-12s %12.2f %12zu\n", "index", chrono::duration<double, micro>(end - middle).count() / checks, indexed / ROUNDS);
+}
+
+/// @brief Distance benchmark: finds the dictionary words within edit distance 1 and 2 of the misspelled words of a
+/// document, with a BK-tree and by computing the distance to every word. Prints the time to build the tree, and for
+/// each distance the words found, the share of the dictionary the tree computed the distance to, and the time per
+/// misspelled word of both.
+/// @param words The words of the dictionary.
+/// @param document_filename The document to check.
+void DistanceBenchmark(const vector<string>& words, const string& document_filename)
+{
+    HashTableDouble<string> dictionary;
+    dictionary.SetRValue(89);
+    dictionary.Reserve(words.size());
+    for (auto& word : words)
+        dictionary.Insert(word);
+    vector<string> misspelled = ReadMisspelled(dictionary, document_filename);
+
+    Clock::time_point start = Clock::now();
+    BKTree tree;
+    tree.Build(words);
+    Clock::time_point end = Clock::now();
+    printf("tree build %.2f ms, %zu words, %zu misspelled words\n\n", chrono::duration<double, milli>(end - start).count(),
+        tree.GetSize(), misspelled.size());
+
+    printf("%-4s %10s %10s %12s %12s\n", "k", "found", "visited", "tree_us", "scan_us");
+    for (size_t k : { 1, 2 })
+    {
+        size_t found = 0;
+        size_t visited = 0;
+        start = Clock::now();
+        for (auto& word : misspelled)
+        {
+            size_t computed;
+            found += tree.Search(word, k, &computed).size();
+            visited += computed;
+        }
+        Clock::time_point middle = Clock::now();
+
+        size_t scanned = 0;
+        for (auto& word : misspelled)
+        {
+            MyersDistance distance(word);
+            for (auto& other : words)
+                scanned += distance.Distance(other) <= k;
+        }
+        end = Clock::now();
+
+        printf("%-4zu %10zu %9.1f%% %12.1f %12.1f\n", k, found, 100.0 * visited / (misspelled.size() * tree.GetSize()),
+            chrono::duration<double, micro>(middle - start).count() / misspelled.size(),
+            chrono::duration<double, micro>(end - middle).count() / misspelled.size());
+    }
+}
+
+/// @brief Times searches one at a time and as one batch, for a list of keys.
+/// @return The nanoseconds per search of both, and the keys found by both.
+template <typename HashTableType>
+void TimeBatch(const HashTableType& hash_table, const vector<string>& keys, size_t rounds, double& single_ns, double& batch_ns, size_t& found)
+{
+    unique_ptr<bool[]> results(new bool[keys.size()]);
+    found = 0;
+    Clock::time_point start = Clock::now();
+    for (size_t round = 0; round < rounds; ++round)
+        for (auto& key : keys)
+            found += hash_table.Contains(key);
+    Clock::time_point middle = Clock::now();
+    for (size_t round = 0; round < rounds; ++round)
+        found -= hash_table.ContainsBatch(keys.data(), keys.size(), results.get());
+    Clock::time_point end = Clock::now();
+
+    single_ns = chrono::duration<double, nano>(middle - start).count() / (rounds * keys.size());
+    batch_ns = chrono::duration<double, nano>(end - middle).count() / (rounds * keys.size());
+}
+
+/// @brief Times searches for every word, every word with a character changed, and the variants the spell checker
+/// makes of misspelled words, one at a time and as batches, and prints the time per search of each. Variants are
+/// batched one misspelled word at a time, as the spell checker submits them; the found columns must be 0, the
+/// number of searches that batches and single searches answered differently.
+/// @tparam HashTableType The type of hash table to test.
+/// @param name The name of the hash table, for the report.
+/// @param hash_table The hash table to search, holding the words.
+/// @param words The words to search for.
+/// @param variants The variants of every misspelled word.
+/// @param rounds The amount of times to search for every key.
+template <typename HashTableType>
+void BatchSearchBenchmark(const string& name, const HashTableType& hash_table, const vector<string>& words,
+    const vector<vector<string>>& variants, size_t rounds)
+{
+    vector<string> misses(words);
+    for (auto& word : misses)
+        word.back() = word.back() == 'z' ? 'a' : word.back() + 1;
+
+    double hit_ns, hit_batch_ns, miss_ns, miss_batch_ns;
+    size_t hit_diff, miss_diff;
+    TimeBatch(hash_table, words, rounds, hit_ns, hit_batch_ns, hit_diff);
+    TimeBatch(hash_table, misses, rounds, miss_ns, miss_batch_ns, miss_diff);
+
+    size_t variant_count = 0;
+    size_t variant_diff = 0;
+    unique_ptr<bool[]> results(new bool[max_element(variants.begin(), variants.end(),
+        [](const vector<string>& a, const vector<string>& b) { return a.size() < b.size(); })->size()]);
+    Clock::time_point start = Clock::now();
+    for (size_t round = 0; round < rounds; ++round)
+        for (auto& list : variants)
+        {
+            for (auto& key : list)
+                variant_diff += hash_table.Contains(key);
+            variant_count += list.size();
+        }
+    Clock::time_point middle = Clock::now();
+    for (size_t round = 0; round < rounds; ++round)
+        for (auto& list : variants)
+            variant_diff -= hash_table.ContainsBatch(list.data(), list.size(), results.get());
+    Clock::time_point end = Clock::now();
+    double variant_ns = chrono::duration<double, nano>(middle - start).count();
+    double variant_batch_ns = chrono::duration<double, nano>(end - middle).count();
+
+    printf("%-16s %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %8zu\n", name.c_str(), hit_ns, hit_batch_ns, miss_ns, miss_batch_ns,
+        variant_ns / variant_count, variant_batch_ns / variant_count, hit_diff + miss_diff + variant_diff);
+}
+
+/// @brief Batch benchmark: runs the batch search benchmark on double hashing tables of the inline and arena layouts
+/// and on a perfect hash dictionary, with the variants of cases A, B and C of the misspelled words of a document.
+/// @param words The words of the dictionary.
+/// @param document_filename The document whose misspelled words to make variants of.
+/// @param rounds The amount of times to search for every key.
+void BatchBenchmark(const vector<string>& words, const string& document_filename, size_t rounds)
+{
+    HashTableDouble<string> inline_table;
+    HashTableDouble<string, PrimeCapacity, ArenaLayout> arena_table;
+    PerfectHashDictionary perfect;
+    inline_table.SetRValue(89);
+    arena_table.SetRValue(89);
+    for (auto& word : words)
+    {
+        inline_table.Insert(word);
+        arena_table.Insert(word);
+    }
+    perfect.Build(words);
+
+    vector<vector<string>> variants;
+    for (auto& word : ReadMisspelled(inline_table, document_filename))
+    {
+        vector<string> list;
+        for (size_t i = 0; i < word.size() + 1; ++i)
+            for (char c = 'a'; c <= 'z'; ++c)
+                list.push_back(word.substr(0, i) + c + word.substr(i));
+        for (size_t i = 0; i < word.size(); ++i)
+            list.push_back(word.substr(0, i) + word.substr(i + 1));
+        for (size_t i = 0; i + 1 < word.size(); ++i)
+        {
+            list.push_back(word);
+            swap(list.back()[i], list.back()[i + 1]);
+        }
+        variants.push_back(move(list));
+    }
+
+    printf("%-16s %9s %9s %9s %9s %9s %9s %8s\n", "table", "hit_ns", "hit_batch", "miss_ns", "miss_batch", "var_ns", "var_batch", "differ");
+    BatchSearchBenchmark("double/inline", inline_table, words, variants, rounds);
+    BatchSearchBenchmark("double/arena", arena_table, words, variants, rounds);
+    BatchSearchBenchmark("perfect", perfect, words, variants, rounds);
+}
+
+/// @brief Memo benchmark: suggests alternatives for the misspelled words of a document, repeated in random order the
+/// way typos repeat through a long text, with cases A, B and C of the spell checker. Runs without a cache and with
+/// suggestion caches of several sizes. Prints the hit rate and evictions of each cache and the time per word.
+/// @param words The words of the dictionary.
+/// @param document_filename The document whose misspelled words to repeat.
+/// @param repeats The amount of times every misspelled word occurs.
+void MemoBenchmark(const vector<string>& words, const string& document_filename, size_t repeats)
+{
+    HashTableDouble<string> dictionary;
+    dictionary.SetRValue(89);
+    dictionary.Reserve(words.size());
+    for (auto& word : words)
+        dictionary.Insert(word);
+
+    vector<string> misspelled = ReadMisspelled(dictionary, document_filename);
+    vector<string> occurrences;
+    for (size_t i = 0; i < repeats; ++i)
+        occurrences.insert(occurrences.end(), misspelled.begin(), misspelled.end());
+    shuffle(occurrences.begin(), occurrences.end(), mt19937(335));
+
+    auto suggest = [&dictionary](const string& word, string& out)
+    {
+        out += word + " is INCORRECT\n";
+        for (size_t i = 0; i < word.size() + 1; ++i)
+            for (char c = 'a'; c <= 'z'; ++c)
+            {
+                string temp = word;
+                temp.insert(i, 1, c);
+                if (dictionary.Contains(temp))
+                    out += "** " + word + " -> " + temp + " ** case A\n";
+            }
+        for (size_t i = 0; i < word.size(); ++i)
+        {
+            string temp = word;
+            temp.erase(i, 1);
+            if (dictionary.Contains(temp))
+                out += "** " + word + " -> " + temp + " ** case B\n";
+        }
+        for (size_t i = 0; i + 1 < word.size(); ++i)
+        {
+            string temp = word;
+            swap(temp[i], temp[i + 1]);
+            if (dictionary.Contains(temp))
+                out += "** " + word + " -> " + temp + " ** case C\n";
+        }
+    };
+
+    printf("%zu misspelled words, %zu occurrences\n\n%-10s %10s %10s %10s %12s\n", misspelled.size(), occurrences.size(),
+        "cache", "capacity", "hit_rate", "evictions", "us_per_word");
+    size_t bytes = 0;
+    string out;
+    Clock::time_point start = Clock::now();
+    for (auto& word : occurrences)
+    {
+        suggest(word, out);
+        bytes += out.size();
+        out.clear();
+    }
+    Clock::time_point end = Clock::now();
+    printf("%-10s %10s %10s %10s %12.2f\n", "none", "-", "-", "-",
+        chrono::duration<double, micro>(end - start).count() / occurrences.size());
+
+    for (size_t capacity : { 16, 64, 4096 })
+    {
+        SuggestionCache cache(capacity);
+        size_t cached_bytes = 0;
+        start = Clock::now();
+        for (auto& word : occurrences)
+        {
+            if (!cache.Find(word, out))
+            {
+                suggest(word, out);
+                cache.Insert(word, out);
+            }
+            cached_bytes += out.size();
+            out.clear();
+        }
+        end = Clock::now();
+        printf("%-10s %10zu %10.3f %10zu %12.2f%s\n", "clock", cache.GetCapacity(), cache.GetHitRate(), cache.GetEvictions(),
+            chrono::duration<double, micro>(end - start).count() / occurrences.size(), cached_bytes == bytes ? "" : " MISMATCH");
+    }
+}
+
+/// @brief Checks the resize path of ConcurrentHashSet: threads insert overlapping ranges of the words into a set of
+/// 64 slots, so every word is inserted by two threads at once while the set grows through many resizes.
+/// @param words The words to insert, each once.
+/// @param threads The amount of threads.
+/// @return True if every word was inserted exactly once and is found, and the size counts every word once.
+bool CheckConcurrentResize(const vector<string>& words, size_t threads)
+{
+    ConcurrentHashSet<string> set(64);
+    atomic<size_t> inserted{ 0 };
+    vector<thread> workers;
+    for (size_t t = 0; t < threads; ++t)
+        workers.emplace_back([&, t]
+        {
+            // Thread t takes shares t and t + 1 of threads + 1, so every share but the first and last has two threads.
+            size_t begin = t * words.size() / (threads + 1);
+            size_t end = (t + 2) * words.size() / (threads + 1);
+            size_t count = 0;
+            for (size_t i = begin; i < end; ++i)
+                count += set.Insert(words[i]);
+            inserted += count;
+        });
+    for (auto& worker : workers)
+        worker.join();
+
+    size_t found = 0;
+    for (auto& word : words)
+        found += set.Contains(word);
+
+    bool passed = inserted == words.size() && set.GetSize() == words.size() && found == words.size();
+    printf("resize check: %zu threads, %zu words, %zu resizes to %zu slots, %zu inserted, size %zu, %zu found, %s\n",
+        threads, words.size(), set.GetResizeCount(), set.GetCapacity(), inserted.load(), set.GetSize(), found,
+        passed ? "passed" : "FAILED");
+    return passed;
+}
+
+/// @brief Concurrent benchmark: checks the resize path with CheckConcurrentResize, then fills a ConcurrentHashSet with every word from 1 to 8 threads, each inserting every
+/// word at its turn in a round robin, then has as many threads search for every word. Prints the time to fill the
+/// set and the searches per second of all threads together, next to a double hashing table filled and searched by
+/// one thread. The collisions are those of every thread, merged from the striped counters.
+/// @param words The words to insert and search for.
+/// @param rounds The amount of times every thread searches for every word.
+void ConcurrentBenchmark(const vector<string>& words, size_t rounds)
+{
+    printf("%u hardware threads\n\n", thread::hardware_concurrency());
+    for (size_t threads : { 2, 4, 8 })
+        CheckConcurrentResize(words, threads);
+
+    printf("\n%-14s %8s %10s %10s %16s %12s\n", "table", "threads",
+        "capacity", "fill_ms", "searches_per_ms", "collisions");
+
+    HashTableDouble<string> baseline;
+    baseline.SetRValue(89);
+    Clock::time_point start = Clock::now();
+    for (auto& word : words)
+        baseline.Insert(word);
+    Clock::time_point middle = Clock::now();
+    size_t found = 0;
+    for (size_t round = 0; round < rounds; ++round)
+        for (auto& word : words)
+            found += baseline.Contains(word);
+    Clock::time_point end = Clock::now();
+    printf("%-14s %8d %10zu %10.2f %16.1f %12s\n", "double", 1, baseline.GetCapacity(),
+        chrono::duration<double, milli>(middle - start).count(),
+        rounds * words.size() / chrono::duration<double, milli>(end - middle).count(), "-");
+
+    for (size_t threads : { 1, 2, 4, 8 })
+    {
+        ConcurrentHashSet<string> set;
+        vector<thread> workers;
+        start = Clock::now();
+        for (size_t t = 0; t < threads; ++t)
+            workers.emplace_back([&, t]
+            {
+                for (size_t i = t; i < words.size(); i += threads)
+                    set.Insert(words[i]);
+            });
+        for (auto& worker : workers)
+            worker.join();
+        middle = Clock::now();
+
+        size_t collisions = set.GetCollisions();
+        atomic<size_t> total{ 0 };
+        workers.clear();
+        for (size_t t = 0; t < threads; ++t)
+            workers.emplace_back([&, t]
+            {
+                size_t hits = 0;
+                for (size_t round = 0; round < rounds; ++round)
+                    for (size_t i = 0; i < words.size(); ++i)
+                        hits += set.Contains(words[(i + t * words.size() / threads) % words.size()]);
+                total += hits;
+            });
+        for (auto& worker : workers)
+            worker.join();
+        end = Clock::now();
+
+        printf("%-14s %8zu %10zu %10.2f %16.1f %12zu%s\n", "concurrent", threads, set.GetCapacity(),
+            chrono::duration<double, milli>(middle - start).count(),
+            threads * rounds * words.size() / chrono::duration<double, milli>(end - middle).count(), collisions,
+            total == threads * rounds * words.size() && set.GetSize() == words.size() ? "" : " MISSING");
+    }
+}
+
+/// @brief Gets the most memory the process has held at once.
+/// @return The peak resident set size in kilobytes.
+size_t PeakResidentKilobytes()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/// @brief Pipeline benchmark: spell checks a large document, made of copies of a smaller one, once by reading every
+/// word into memory and checking them one at a time, and once with the streaming pipeline at several thread counts.
+/// A word is checked by searching for it and, if it is misspelled, for the words with a letter removed or two
+/// neighbors swapped; the output goes to /dev/null. Prints the throughput of each run and the peak memory of the
+/// process after it. The pipeline runs first, as the peak only grows.
+/// @param words The words of the dictionary.
+/// @param document_filename The document to copy.
+/// @param copies The amount of copies of the document in the large one.
+void PipelineBenchmark(const vector<string>& words, const string& document_filename, size_t copies)
+{
+    HashTableDouble<string> table;
+    table.SetRValue(89);
+    table.Reserve(words.size());
+    for (auto& word : words)
+        table.Insert(word);
+    const HashTableDouble<string>& dictionary = table;
+
+    auto check = [&dictionary](const string& word, string& out)
+    {
+        if (dictionary.Contains(word))
+        {
+            out += word + " is CORRECT\n";
+            return;
+        }
+
+        out += word + " is INCORRECT\n";
+        for (size_t i = 0; i < word.size(); ++i)
+        {
+            string temp = word;
+            temp.erase(i, 1);
+            if (dictionary.Contains(temp))
+                out += "** " + word + " -> " + temp + " ** case B\n";
+        }
+        for (size_t i = 0; i + 1 < word.size(); ++i)
+        {
+            string temp = word;
+            swap(temp[i], temp[i + 1]);
+            if (dictionary.Contains(temp))
+                out += "** " + word + " -> " + temp + " ** case C\n";
+        }
+    };
+    auto normalize = [](string& word)
+    {
+        transform(word.begin(), word.end(), word.begin(), [](unsigned char c) { return tolower(c); });
+        if (!word.empty() && !isalnum((unsigned char)word.front()))
+            word.erase(0, 1);
+        if (!word.empty() && !isalnum((unsigned char)word.back()))
+            word.pop_back();
+    };
+
+    const string big_filename = document_filename + ".big";
+    {
+        ifstream document(document_filename, ios::binary);
+        string text((istreambuf_iterator<char>(document)), istreambuf_iterator<char>());
+        ofstream big(big_filename, ios::binary | ios::trunc);
+        for (size_t i = 0; i < copies; ++i)
+            big << text << '\n';
+    }
+    struct stat info;
+    stat(big_filename.c_str(), &info);
+    double megabytes = info.st_size / 1048576.0;
+    ofstream null("/dev/null");
+
+    printf("document %.1f MB, %u hardware threads, peak before %zu KB\n\n%-12s %10s %10s %12s\n", megabytes,
+        thread::hardware_concurrency(), PeakResidentKilobytes(), "checker", "seconds", "MB_per_s", "peak_kb");
+    for (size_t threads : { 1, 2, 4, 8 })
+    {
+        SpellPipeline pipeline(threads);
+        Clock::time_point start = Clock::now();
+        pipeline.Run(big_filename, [&](string_view chunk, string& out)
+        {
+            DocumentTokenizer tokenizer(chunk);
+            string_view token;
+            string word;
+            while (tokenizer.Next(token))
+            {
+                word.assign(token.data(), token.size());
+                check(word, out);
+            }
+        }, null);
+        double seconds = chrono::duration<double>(Clock::now() - start).count();
+        printf("%-12s %10.3f %10.1f %12zu\n", ("pipeline/" + to_string(threads)).c_str(), seconds, megabytes / seconds,
+            PeakResidentKilobytes());
+    }
+
+    Clock::time_point start = Clock::now();
+    vector<string> document = ReadWords(big_filename);
+    string out;
+    for (auto& word : document)
+    {
+        normalize(word);
+        if (word.empty())
+            continue;
+        check(word, out);
+        null << out;
+        out.clear();
+    }
+    null.flush();
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+    printf("%-12s %10.3f %10.1f %12zu\n", "sequential", seconds, megabytes / seconds, PeakResidentKilobytes());
+
+    remove(big_filename.c_str());
+}
+
+/// @brief Tokenize benchmark: splits copies of a document into words, once the way the spell checker used to, reading
+/// whitespace separated strings from a stream and building each word a character at a time, and once with the
+/// table driven DocumentTokenizer over the raw bytes. Prints the words found and the time per word and per megabyte.
+/// @param document_filename The document to copy.
+/// @param copies The amount of copies of the document to split.
+void TokenizeBenchmark(const string& document_filename, size_t copies)
+{
+    ifstream document(document_filename, ios::binary);
+    string copy((istreambuf_iterator<char>(document)), istreambuf_iterator<char>());
+    string text;
+    for (size_t i = 0; i < copies; ++i)
+        text += copy + '\n';
+    double megabytes = text.size() / 1048576.0;
+
+    Clock::time_point start = Clock::now();
+    istringstream stream(text);
+    vector<string> words;
+    string line;
+    while (stream >> line)
+    {
+        string word = "";
+        for (auto& c : line)
+            word += tolower(c);
+        if (!isalpha(word[0]) && !isdigit(word[0]))
+            word = word.substr(1);
+        if (!word.empty() && !isalpha(word[word.size() - 1]) && !isdigit(word[word.size() - 1]))
+            word.pop_back();
+        if (!word.empty())
+            words.push_back(word);
+    }
+    Clock::time_point middle = Clock::now();
+
+    size_t tokens = 0;
+    size_t checksum = 0;
+    DocumentTokenizer tokenizer(text);
+    string_view word;
+    while (tokenizer.Next(word))
+    {
+        ++tokens;
+        checksum += word.size();
+    }
+    Clock::time_point end = Clock::now();
+
+    size_t stream_checksum = 0;
+    for (auto& w : words)
+        stream_checksum += w.size();
+    printf("document %.1f MB\n\n%-10s %10s %12s %10s %10s\n", megabytes, "tokenizer", "words", "characters", "ns_per_word", "MB_per_s");
+    printf("%-10s %10zu %12zu %10.1f %10.1f\n", "stream", words.size(), stream_checksum,
+        chrono::duration<double, nano>(middle - start).count() / words.size(), megabytes / chrono::duration<double>(middle - start).count());
+    printf("%-10s %10zu %12zu %10.1f %10.1f\n", "table", tokens, checksum,
+        chrono::duration<double, nano>(end - middle).count() / tokens, megabytes / chrono::duration<double>(end - middle).count());
+}
+
+/// @brief Wrapper function to run a benchmark.
+/// @param argument_count argc as provided in main.
+/// @param argument_list argv as provided in main.
+/// @return 0 if successful.
+int benchmarkWrapper(int argument_count, char** argument_list)
+{
+    const string mode(argument_list[1]);
+    const string words_filename(argument_list[2]);
+    const vector<string> words = ReadWords(words_filename);
+
+    if (mode == "churn")
+    {
+        size_t rounds = argument_count == 4 ? stoul(argument_list[3]) : 100;
+
+        printf("%-12s %8s %10s %12s %12s %12s %10s %10s\n", "table", "round", "capacity", "hit_probes", "miss_probes", "collisions", "ns_per_op", "key_kb");
+        ChurnBenchmark<HashTableLinear<string>>("linear", words, rounds);
+        ChurnBenchmark<HashTableRobinHood<string>>("robinhood", words, rounds);
+        ChurnBenchmark<HashTableLinear<string, PrimeCapacity, ArenaLayout>>("linear/arena", words, rounds);
+    }
+    else if (mode == "drain")
+    {
+        printf("%-18s %10s %10s %10s %12s %12s %10s\n", "table", "peak", "drained", "tombstones", "hit_probes", "miss_probes", "remove_ns");
+        DrainBenchmark<HashTableLinear<string>>("linear", words);
+        DrainBenchmark<HashTableDouble<string>>("double", words);
+        DrainBenchmark<HashTableRobinHood<string>>("robinhood", words);
+        DrainBenchmark<HashTableSwiss<string>>("swiss", words);
+    }
+    else if (mode == "latency")
+    {
+        vector<vector<size_t>> histograms;
+
+        printf("%-22s %10s %10s %10s %10s %12s\n", "table", "capacity", "p50_ns", "p99_ns", "p99.9_ns", "max_ns");
+        LatencyPair<HashTableLinear<string>>("linear", words, 0, histograms);
+        LatencyPair<HashTable<string>>("quadratic", words, 0, histograms);
+        LatencyPair<HashTableDouble<string>>("double", words, 89, histograms);
+
+        // One row per bucket that any run landed in, one column per run in the order above.
+        printf("\n%-12s", "<=ns");
+        for (auto& name : { "linear", "quadratic", "double" })
+            printf(" %10s %10s", (string(name) + "/s").c_str(), (string(name) + "/i").c_str());
+        printf("\n");
+        for (size_t bucket = 0; bucket < 32; ++bucket)
+        {
+            size_t total = 0;
+            for (auto& histogram : histograms)
+                total += histogram[bucket];
+            if (total == 0)
+                continue;
+
+            printf("%-12llu", 1ull << bucket);
+            for (auto& histogram : histograms)
+                printf(" %10zu", histogram[bucket]);
+            printf("\n");
+        }
+    }
+    else if (mode == "lookup")
+    {
+        size_t rounds = argument_count == 4 ? stoul(argument_list[3]) : 10;
+        HashTableLinear<string> linear;
+        HashTable<string> quadratic;
+        HashTableDouble<string> double_hashing;
+        HashTableRobinHood<string> robin_hood;
+        double_hashing.SetRValue(89);
+
+        printf("%-20s %10s %12s %12s %10s\n", "table", "capacity", "hit_ns", "miss_ns", "found");
+        LookupBenchmark("linear", linear, words, rounds);
+        LookupBenchmark("quadratic", quadratic, words, rounds);
+        LookupBenchmark("double", double_hashing, words, rounds);
+        LookupBenchmark("robinhood", robin_hood, words, rounds);
+    }
+    else if (mode == "capacity")
+    {
+        size_t rounds = argument_count == 4 ? stoul(argument_list[3]) : 10;
+
+        printf("%-20s %10s %12s %12s %10s\n", "table", "capacity", "hit_ns", "miss_ns", "found");
+        CapacityBenchmark<HashTableLinear>("linear", words, rounds, 0);
+        CapacityBenchmark<HashTable>("quadratic", words, rounds, 0);
+        CapacityBenchmark<HashTableDouble>("double", words, rounds, 89);
+    }
+    else if (mode == "load")
+    {
+        printf("%-10s %6s %8s %10s %9s %10s %10s %10s\n", "table", "load", "sizing", "capacity", "rehashes", "fill_ms", "hit_probes", "hit_ns");
+        for (double load_factor : { 0.5, 0.625, 0.75, 0.875 })
+            for (bool reserve : { false, true })
+            {
+                LoadBenchmark<HashTableLinear<string>>("linear", words, load_factor, reserve);
+                LoadBenchmark<HashTableDouble<string>>("double", words, load_factor, reserve);
+                LoadBenchmark<HashTableRobinHood<string>>("robinhood", words, load_factor, reserve);
+                LoadBenchmark<HashTableSwiss<string>>("swiss", words, load_factor, reserve);
+            }
+    }
+    else if (mode == "arena")
+    {
+        size_t rounds = argument_count == 4 ? stoul(argument_list[3]) : 10;
+
+        printf("%-10s %10s %10s %10s %12s %10s %10s %10s\n", "layout", "capacity", "fill_ms", "heap_kb", "bytes_per_key", "hit_ns", "view_ns", "found");
+        ArenaBenchmark<InlineLayout>("inline", words, rounds);
+        ArenaBenchmark<SplitLayout>("split", words, rounds);
+        ArenaBenchmark<ArenaLayout>("arena", words, rounds);
+    }
+    else if (mode == "bloom")
+    {
+        size_t rounds = argument_count == 4 ? stoul(argument_list[3]) : 10;
+        HashTableDouble<string> plain;
+        BloomFilteredTable<HashTableDouble<string>> filtered;
+        plain.SetRValue(89);
+        plain.Reserve(words.size());
+        filtered.GetTable().SetRValue(89);
+        filtered.Reserve(words.size());
+
+        printf("%-20s %10s %12s %12s %10s\n", "table", "capacity", "hit_ns", "miss_ns", "found");
+        LookupBenchmark("double", plain, words, rounds);
+        LookupBenchmark("double/bloom", filtered, words, rounds);
+        printf("\nfilter %zu bytes, %zu passed, %zu rejected, %zu false positives, rate %.4f (expected %.4f)\n",
+            filtered.GetFilter().GetBytes(), filtered.GetFilterPasses(), filtered.GetFilterRejects(),
+            filtered.GetFalsePositives(), filtered.GetFalsePositiveRate(), filtered.GetFilter().GetExpectedFalsePositiveRate());
+    }
+    else if (mode == "suggest")
+        SuggestBenchmark(words, argument_count == 4 ? argument_list[3] : "Tests/document1.txt");
+    else if (mode == "distance")
+        DistanceBenchmark(words, argument_count == 4 ? argument_list[3] : "Tests/document1.txt");
+    else if (mode == "concurrent")
+        ConcurrentBenchmark(words, argument_count == 4 ? stoul(argument_list[3]) : 10);
+    else if (mode == "batch")
+        BatchBenchmark(words, "Tests/document1.txt", argument_count == 4 ? stoul(argument_list[3]) : 10);
+    else if (mode == "memo")
+        MemoBenchmark(words, argument_count == 4 ? argument_list[3] : "Tests/document1.txt", 100);
+    else if (mode == "tokenize")
+        TokenizeBenchmark(argument_count == 4 ? argument_list[3] : "Tests/document1.txt", 2000);
+    else if (mode == "pipeline")
+        PipelineBenchmark(words, argument_count == 4 ? argument_list[3] : "Tests/document1.txt", 2000);
+    else if (mode == "perfect")
+        PerfectBenchmark(words, words_filename + ".phd", argument_count == 4 ? stoul(argument_list[3]) : 10);
+    else
+        cout << "Unknown benchmark " << mode << " (User should provide churn, drain, latency, lookup, capacity, load, arena, bloom, perfect, batch, concurrent, suggest, distance, memo, tokenize or pipeline)" << endl;
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3 && argc != 4)
+    {
+        cout << "Usage: " << argv[0] << " churn|drain|latency|lookup|capacity|load|arena|bloom|perfect|batch <wordsfilename> [rounds]" << endl;
+        cout << "or Usage: " << argv[0] << " concurrent <wordsfilename> [search rounds]" << endl;
+        cout << "or Usage: " << argv[0] << " suggest|distance|memo|tokenize|pipeline <wordsfilename> [documentfilename]" << endl;
+        return 0;
+    }
+
+    benchmarkWrapper(argc, argv);
+    return 0;
+}
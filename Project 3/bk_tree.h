@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/// @brief Levenshtein distance from one fixed word to others, computed with Myers' bit-parallel algorithm in
+/// Hyyro's form. Each column of the dynamic programming table is held as bit vectors of the differences between
+/// neighboring cells, so a character of the other word costs a handful of word operations instead of a column of
+/// cells. Words of up to 64 characters fit in one machine word; longer ones fall back to the table.
+class MyersDistance
+{
+public:
+    /// @brief Prepares the match masks of a word.
+    /// @param pattern The fixed word.
+    explicit MyersDistance(std::string_view pattern) : pattern_(pattern)
+    {
+        std::fill(std::begin(peq_), std::end(peq_), 0);
+        if (pattern.size() <= 64)
+            for (size_t i = 0; i < pattern.size(); ++i)
+                peq_[static_cast<unsigned char>(pattern[i])] |= uint64_t(1) << i;
+    }
+
+    /// @brief Computes the edit distance from the fixed word to another.
+    /// @param text The other word.
+    /// @return The least amount of single character insertions, deletions and substitutions between the words.
+    size_t Distance(std::string_view text) const
+    {
+        size_t m = pattern_.size();
+        if (m == 0)
+            return text.size();
+        if (m > 64)
+            return TableDistance(text);
+
+        uint64_t pv = ~uint64_t(0);
+        uint64_t mv = 0;
+        uint64_t last = uint64_t(1) << (m - 1);
+        size_t score = m;
+
+        for (unsigned char c : text)
+        {
+            uint64_t eq = peq_[c];
+            uint64_t xv = eq | mv;
+            uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+            uint64_t ph = mv | ~(xh | pv);
+            uint64_t mh = pv & xh;
+
+            if (ph & last)
+                ++score;
+            else if (mh & last)
+                --score;
+
+            // The top row of the table grows by one every column, so a 1 shifts into the horizontal increases.
+            ph = (ph << 1) | 1;
+            mh <<= 1;
+            pv = mh | ~(xv | ph);
+            mv = ph & xv;
+        }
+
+        return score;
+    }
+
+private:
+    std::string_view pattern_;
+    uint64_t peq_[256];     // Bit i of the mask of a character is set if the character is at position i of the word
+
+    /// @brief Computes the edit distance with the dynamic programming table, one row at a time.
+    size_t TableDistance(std::string_view text) const
+    {
+        std::vector<size_t> row(pattern_.size() + 1);
+        for (size_t i = 0; i < row.size(); ++i)
+            row[i] = i;
+
+        for (size_t j = 1; j <= text.size(); ++j)
+        {
+            size_t diagonal = row[0];
+            row[0] = j;
+            for (size_t i = 1; i < row.size(); ++i)
+            {
+                size_t above = row[i];
+                row[i] = std::min({ row[i] + 1, row[i - 1] + 1, diagonal + (pattern_[i - 1] != text[j - 1]) });
+                diagonal = above;
+            }
+        }
+
+        return row.back();
+    }
+};
+
+
+/// @brief BK-tree of the words of a dictionary under edit distance. Every child hangs under its parent at its
+/// distance from the parent, so by the triangle inequality a search for the words within k of a query only descends
+/// into the children whose distance from the node is within k of the query's, and skips the other subtrees whole.
+/// Nodes sit in one array and keep their children as a list of siblings; the words share one buffer of characters.
+class BKTree
+{
+public:
+    /// @brief Builds the tree from a list of words, replacing what it held. Repeated words are kept once.
+    /// @param words The words of the dictionary.
+    void Build(const std::vector<std::string>& words)
+    {
+        chars_.clear();
+        nodes_.clear();
+        for (auto& word : words)
+            Insert(word);
+    }
+
+    /// @brief Finds every word within an edit distance of a query.
+    /// @param x The query.
+    /// @param k The largest distance.
+    /// @param visited If not nullptr, set to the number of words the search computed the distance to.
+    /// @return The words and their distances, sorted by distance and then word.
+    std::vector<std::pair<size_t, std::string_view>> Search(std::string_view x, size_t k, size_t* visited = nullptr) const
+    {
+        std::vector<std::pair<size_t, std::string_view>> results;
+        std::vector<uint32_t> pending;
+        MyersDistance distance(x);
+        size_t computed = 0;
+
+        if (!nodes_.empty())
+            pending.push_back(0);
+        while (!pending.empty())
+        {
+            const Node& node = nodes_[pending.back()];
+            pending.pop_back();
+
+            size_t d = distance.Distance(Word(node));
+            ++computed;
+            if (d <= k)
+                results.emplace_back(d, Word(node));
+
+            for (uint32_t child = node.first_child_; child != NONE; child = nodes_[child].next_sibling_)
+                if (nodes_[child].distance_ + k >= d && nodes_[child].distance_ <= d + k)
+                    pending.push_back(child);
+        }
+
+        if (visited != nullptr)
+            *visited = computed;
+        std::sort(results.begin(), results.end());
+        return results;
+    }
+
+    /// @brief Get the amount of words in the tree.
+    /// @return The number of nodes.
+    size_t GetSize() const
+    {
+        return nodes_.size();
+    }
+
+private:
+    static const uint32_t NONE = static_cast<uint32_t>(-1);
+
+    struct Node
+    {
+        uint32_t offset_;           // The word of the node in chars_
+        uint32_t length_;
+        uint32_t distance_;         // The distance from the word of the parent
+        uint32_t first_child_ = NONE;
+        uint32_t next_sibling_ = NONE;
+    };
+
+    std::string chars_;
+    std::vector<Node> nodes_;
+
+    std::string_view Word(const Node& node) const
+    {
+        return std::string_view(chars_.data() + node.offset_, node.length_);
+    }
+
+    /// @brief Hangs a word under the first node on its path with no child at its distance.
+    /// @param x The word to insert.
+    void Insert(std::string_view x)
+    {
+        Node node;
+        node.offset_ = static_cast<uint32_t>(chars_.size());
+        node.length_ = static_cast<uint32_t>(x.size());
+        node.distance_ = 0;
+
+        uint32_t current = 0;
+        MyersDistance distance(x);
+        while (!nodes_.empty())
+        {
+            size_t d = distance.Distance(Word(nodes_[current]));
+            if (d == 0)
+                return;
+
+            uint32_t* link = &nodes_[current].first_child_;
+            while (*link != NONE && nodes_[*link].distance_ != d)
+                link = &nodes_[*link].next_sibling_;
+
+            if (*link == NONE)
+            {
+                node.distance_ = static_cast<uint32_t>(d);
+                *link = static_cast<uint32_t>(nodes_.size());
+                break;
+            }
+            current = *link;
+        }
+
+        chars_.append(x.data(), x.size());
+        nodes_.push_back(node);
+    }
+};
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "capacity_policy.h"
+
+/// @brief Split block Bloom filter. Each key sets one bit in each of the 8 words of a single 32 byte block, so a
+/// check reads one block, which fits in half a cache line, instead of k lines spread over the filter. It answers
+/// either that a key is certainly absent or that it may be present. Keys cannot be removed.
+class BlockedBloomFilter
+{
+public:
+    /// @brief Construct a filter sized for a number of keys.
+    /// @param keys The number of keys the filter will hold.
+    /// @param bits_per_key The bits to spend on every key, 10 gives about 1% false positives.
+    explicit BlockedBloomFilter(size_t keys = 0, size_t bits_per_key = 10)
+    {
+        Resize(keys, bits_per_key);
+    }
+
+    /// @brief Empties the filter and sizes it for a number of keys.
+    /// @param keys The number of keys the filter will hold.
+    /// @param bits_per_key The bits to spend on every key.
+    void Resize(size_t keys, size_t bits_per_key = 10)
+    {
+        blocks_.assign(std::max<size_t>(1, (keys * bits_per_key + BLOCK_BITS - 1) / BLOCK_BITS), Block{ });
+        keys_ = 0;
+    }
+
+    /// @brief Adds a key to the filter.
+    /// @param hash The mixed 64-bit hash of the key.
+    void Insert(uint64_t hash)
+    {
+        Block& block = blocks_[BlockOf(hash)];
+        for (size_t i = 0; i < WORDS; ++i)
+            block.words_[i] |= BitOf(hash, i);
+        ++keys_;
+    }
+
+    /// @brief Checks a key against the filter.
+    /// @param hash The mixed 64-bit hash of the key.
+    /// @return False if the key was never inserted, true if it may have been.
+    bool MayContain(uint64_t hash) const
+    {
+        const Block& block = blocks_[BlockOf(hash)];
+        uint32_t missing = 0;
+        for (size_t i = 0; i < WORDS; ++i)
+            missing |= ~block.words_[i] & BitOf(hash, i);
+        return missing == 0;
+    }
+
+    /// @brief Get the size of the filter.
+    /// @return The number of bytes of the blocks.
+    size_t GetBytes() const
+    {
+        return blocks_.size() * sizeof(Block);
+    }
+
+    /// @brief Get the false positive rate the filter is expected to have with the keys inserted so far, treating every
+    /// block as a standard Bloom filter of 8 hashes over 256 bits that holds the average number of keys. Blocks that
+    /// hold more than the average make the real rate somewhat higher.
+    /// @return The expected fraction of absent keys the filter lets through.
+    double GetExpectedFalsePositiveRate() const
+    {
+        double keys_per_block = (double)keys_ / blocks_.size();
+        return std::pow(1 - std::exp(-(double)WORDS * keys_per_block / BLOCK_BITS), WORDS);
+    }
+
+private:
+    static const size_t WORDS = 8;                  // Words of a block, each key sets one bit in each
+    static const size_t BLOCK_BITS = WORDS * 32;
+
+    struct alignas(32) Block
+    {
+        uint32_t words_[WORDS];
+    };
+
+    std::vector<Block> blocks_;
+    size_t keys_ = 0;
+
+    /// @brief Gets the block of a key, from the high half of its hash.
+    size_t BlockOf(uint64_t hash) const
+    {
+        return static_cast<size_t>(((hash >> 32) * blocks_.size()) >> 32);
+    }
+
+    /// @brief Gets the bit of a key in a word of its block, from the low half of its hash times an odd salt per word.
+    static uint32_t BitOf(uint64_t hash, size_t word)
+    {
+        static const uint32_t SALTS[WORDS] = {
+            0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+            0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u };
+        return 1u << ((static_cast<uint32_t>(hash) * SALTS[word]) >> 27);
+    }
+};
+
+
+/// @brief A hash table with a Bloom filter in front, for lookups that mostly miss such as the variants of a spell
+/// checker. Every insert also goes into the filter, and a search only reaches the table when the filter lets it
+/// through. The filter is sized by Reserve, so it should be called before the first insert; a filter that holds more
+/// keys than it was sized for still never rejects a key in the table, it only lets more absent keys through.
+/// @tparam HashTableType The type of hash table behind the filter.
+/// @tparam Key The type of object stored.
+template <typename HashTableType, typename Key = std::string>
+class BloomFilteredTable
+{
+public:
+    /// @brief Get the hash table behind the filter, to configure it.
+    /// @return The hash table.
+    HashTableType& GetTable()
+    {
+        return table_;
+    }
+
+    /// @brief Grows the table so a given number of objects fit without a rehash, and sizes the filter for them if it
+    /// is still empty.
+    /// @param size The number of objects.
+    void Reserve(size_t size)
+    {
+        if (inserts_ == 0)
+            filter_.Resize(size);
+        table_.Reserve(size);
+    }
+
+    /// @brief Insert a new object into the table and the filter.
+    /// @param x The object to insert.
+    /// @return True if the object was inserted, false if the object already exists.
+    bool Insert(const Key& x)
+    {
+        filter_.Insert(FilterHash(x));
+        ++inserts_;
+        return table_.Insert(x);
+    }
+
+    /// @brief Determine if the table contains a given object, asking the filter first.
+    /// @tparam K Key, or a type that compares and hashes the same, such as std::string_view for std::string.
+    /// @param x The object to search for.
+    /// @return True if the object is in the table, false otherwise.
+    template <typename K>
+    bool Contains(const K& x)
+    {
+        if (!filter_.MayContain(FilterHash(x)))
+        {
+            ++filter_rejects_;
+            return false;
+        }
+
+        ++filter_passes_;
+        if (table_.Contains(x))
+            return true;
+
+        ++false_positives_;
+        return false;
+    }
+
+    /// @brief Get the current capacity of the table.
+    /// @return The number of slots in the table.
+    size_t GetCapacity() const
+    {
+        return table_.GetCapacity();
+    }
+
+    /// @brief Get the filter in front of the table.
+    /// @return The filter.
+    const BlockedBloomFilter& GetFilter() const
+    {
+        return filter_;
+    }
+
+    /// @brief Get the amount of searches the filter let through to the table.
+    size_t GetFilterPasses() const
+    {
+        return filter_passes_;
+    }
+
+    /// @brief Get the amount of searches the filter answered without the table.
+    size_t GetFilterRejects() const
+    {
+        return filter_rejects_;
+    }
+
+    /// @brief Get the amount of searches the filter let through that the table then missed.
+    size_t GetFalsePositives() const
+    {
+        return false_positives_;
+    }
+
+    /// @brief Get the fraction of searches for absent objects that the filter let through.
+    /// @return The measured false positive rate, 0 before any search missed.
+    double GetFalsePositiveRate() const
+    {
+        size_t misses = false_positives_ + filter_rejects_;
+        return misses == 0 ? 0 : (double)false_positives_ / misses;
+    }
+
+private:
+    HashTableType table_;
+    BlockedBloomFilter filter_;
+    size_t inserts_ = 0;
+    size_t filter_passes_ = 0;
+    size_t filter_rejects_ = 0;
+    size_t false_positives_ = 0;
+
+    /// @brief Hash function for the filter, mixed so both halves of the hash are usable.
+    /// @param x The object to hash.
+    /// @return The hash value of the object.
+    template <typename K>
+    static uint64_t FilterHash(const K& x)
+    {
+        static std::hash<K> hf;
+        return MixHash(hf(x));
+    }
+};
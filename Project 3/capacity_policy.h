@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+
+namespace
+{
+    /// @brief Capacities of PrimeCapacity, sorted. Holds every prime reached from 101 by taking the next prime after
+    /// twice the last one, so tables grow exactly as they did with trial division, and between those, primes a quarter
+    /// of a power of two apart for tables constructed with other sizes.
+    constexpr uint64_t CAPACITY_PRIMES[] = {
+        5ull, 7ull, 11ull, 13ull, 17ull, 19ull,
+        23ull, 29ull, 37ull, 41ull, 47ull, 53ull,
+        67ull, 79ull, 97ull, 101ull, 107ull, 131ull,
+        157ull, 181ull, 211ull, 223ull, 257ull, 307ull,
+        367ull, 431ull, 521ull, 613ull, 727ull, 863ull,
+        1031ull, 1217ull, 1451ull, 1723ull, 1733ull, 2053ull,
+        2437ull, 2897ull, 3449ull, 3467ull, 4099ull, 4871ull,
+        5801ull, 6899ull, 6947ull, 8209ull, 9743ull, 11587ull,
+        13781ull, 13901ull, 16411ull, 19483ull, 23173ull, 27581ull,
+        27803ull, 32771ull, 38971ull, 46349ull, 55109ull, 55609ull,
+        65537ull, 77951ull, 92681ull, 110221ull, 111227ull, 131101ull,
+        155887ull, 185363ull, 220447ull, 222461ull, 262147ull, 311743ull,
+        370759ull, 440893ull, 444929ull, 524309ull, 623521ull, 741457ull,
+        881743ull, 889871ull, 1048583ull, 1246997ull, 1482919ull, 1763491ull,
+        1779761ull, 2097169ull, 2493949ull, 2965847ull, 3526987ull, 3559537ull,
+        4194319ull, 4987901ull, 5931641ull, 7053971ull, 7119103ull, 8388617ull,
+        9975803ull, 11863289ull, 14107921ull, 14238221ull, 16777259ull, 19951597ull,
+        23726569ull, 28215809ull, 28476473ull, 33554467ull, 39903197ull, 47453149ull,
+        56431657ull, 56952947ull, 67108879ull, 79806341ull, 94906297ull, 112863217ull,
+        113905901ull, 134217757ull, 159612679ull, 189812533ull, 225726419ull, 227811809ull,
+        268435459ull, 319225391ull, 379625083ull, 451452839ull, 455623621ull, 536870923ull,
+        638450719ull, 759250133ull, 902905657ull, 911247257ull, 1073741827ull, 1276901429ull,
+        1518500279ull, 1805811341ull, 1822494581ull, 2147483659ull, 2553802871ull, 3037000507ull,
+        3611622607ull, 3644989199ull, 4294967311ull, 5107605691ull, 6074001001ull, 7223245229ull,
+        7289978407ull, 8589934609ull, 10215211387ull, 12148002047ull, 14446490449ull, 14579956817ull,
+        17179869209ull, 20430422699ull, 24296004011ull, 28892980877ull, 29159913637ull, 34359738421ull,
+        40860845437ull, 48592008053ull, 57785961671ull, 58319827297ull, 68719476767ull, 81721690807ull,
+        97184016049ull, 115571923303ull, 116639654657ull, 137438953481ull, 163443381347ull, 194368032011ull,
+        231143846587ull, 233279309317ull, 274877906951ull, 326886762733ull, 388736063999ull, 462287693167ull,
+        466558618639ull, 549755813911ull, 653773525393ull, 777472128049ull, 924575386373ull, 933117237293ull,
+        1099511627791ull, 1307547050819ull, 1554944255989ull, 1849150772699ull, 1866234474589ull, 2199023255579ull,
+        2615094101561ull, 3109888512037ull, 3698301545321ull, 3732468949199ull, 4398046511119ull, 5230188203153ull,
+        6219777023959ull, 7396603090651ull, 7464937898399ull, 8796093022237ull, 10460376406273ull, 12439554047911ull,
+        14793206181251ull, 14929875796813ull, 17592186044423ull, 20920752812471ull, 24879108095833ull, 29586412362491ull,
+        29859751593667ull, 35184372088891ull, 41841505624973ull, 49758216191633ull, 59172824724919ull, 59719503187441ull,
+        70368744177679ull, 83683011249917ull, 99516432383281ull, 118345649449813ull, 119439006374939ull, 140737488355333ull,
+        167366022499847ull, 199032864766447ull, 236691298899683ull, 238878012749879ull
+    };
+
+    /// @brief Internal method to mix the bits of a hash, so every bit of the result depends on every bit of the hash.
+    /// This is the 64-bit finalizer of MurmurHash3.
+    /// @param hash The hash to mix.
+    /// @return The mixed hash.
+    uint64_t MixHash(uint64_t hash)
+    {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+}  // namespace
+
+
+/// @brief Capacity policy of prime capacities, with hashes reduced to a slot by modulo. The default of the tables.
+/// Capacities are looked up in a precomputed list of primes from 5 to about 2^48.
+struct PrimeCapacity
+{
+    static const size_t QUADRATIC_OFFSET_STEP = 2;  // Offsets 1, 3, 5, ... probe i^2 slots past home
+
+    /// @brief Gets the capacity of a table of at least n slots.
+    /// @param n The least number of slots.
+    /// @return The smallest listed prime at least as large as n.
+    static size_t NextCapacity(size_t n)
+    {
+        return *std::lower_bound(std::begin(CAPACITY_PRIMES), std::end(CAPACITY_PRIMES) - 1, n);
+    }
+
+    /// @brief Mixes a hash before it is stored and reduced, prime capacities use the hash as it is.
+    /// @param hash The hash of an object.
+    /// @return The hash.
+    static size_t Mix(size_t hash)
+    {
+        return hash;
+    }
+
+    /// @brief Reduces a hash to a slot.
+    /// @param hash The mixed hash of an object.
+    /// @param capacity The number of slots.
+    /// @return The home slot of the hash.
+    static size_t Reduce(size_t hash, size_t capacity)
+    {
+        return hash % capacity;
+    }
+
+    /// @brief Reduces a double hashing step so the probe sequence reaches every slot.
+    /// @param step The step, at least 1.
+    /// @param capacity The number of slots.
+    /// @return The step to probe with, any step below a prime capacity works.
+    static size_t Step(size_t step, size_t capacity)
+    {
+        return step % capacity;
+    }
+};
+
+/// @brief Capacity policy of power of two capacities, with mixed hashes reduced to a slot by masking their low bits.
+/// Avoids the division of a modulo on every search.
+struct PowerOfTwoCapacity
+{
+    static const size_t QUADRATIC_OFFSET_STEP = 1;  // Offsets 1, 2, 3, ... probe triangular numbers, which reach every slot
+
+    /// @brief Gets the capacity of a table of at least n slots.
+    /// @param n The least number of slots.
+    /// @return The smallest power of two at least as large as n, and at least 8.
+    static size_t NextCapacity(size_t n)
+    {
+        size_t capacity = 8;
+        while (capacity < n)
+            capacity *= 2;
+
+        return capacity;
+    }
+
+    /// @brief Mixes a hash before it is stored and reduced, so the slot depends on all of its bits.
+    /// @param hash The hash of an object.
+    /// @return The mixed hash.
+    static size_t Mix(size_t hash)
+    {
+        return MixHash(hash);
+    }
+
+    /// @brief Reduces a hash to a slot.
+    /// @param hash The mixed hash of an object.
+    /// @param capacity The number of slots.
+    /// @return The low bits of the hash.
+    static size_t Reduce(size_t hash, size_t capacity)
+    {
+        return hash & (capacity - 1);
+    }
+
+    /// @brief Reduces a double hashing step so the probe sequence reaches every slot.
+    /// @param step The step, at least 1.
+    /// @param capacity The number of slots.
+    /// @return The step made odd, which is coprime with a power of two.
+    static size_t Step(size_t step, size_t capacity)
+    {
+        return (step | 1) & (capacity - 1);
+    }
+};
+
+/// @brief Capacity policy of power of two capacities, with mixed hashes reduced to a slot by Lemire's fastrange:
+/// the high half of the hash times the capacity, which takes the high bits of the hash instead of the low ones.
+struct FastRangeCapacity : PowerOfTwoCapacity
+{
+    /// @brief Reduces a hash to a slot.
+    /// @param hash The mixed hash of an object.
+    /// @param capacity The number of slots.
+    /// @return The hash scaled down to the range of slots.
+    static size_t Reduce(size_t hash, size_t capacity)
+    {
+        return static_cast<size_t>((static_cast<unsigned __int128>(hash) * capacity) >> 64);
+    }
+};
@@ -0,0 +1,434 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "capacity_policy.h"
+#include "table_diagnostics.h"
+
+/// @brief Open addressing hash set that any number of threads can insert into and search at once, for building a
+/// dictionary in parallel and sharing it between threads. Objects cannot be removed.
+/// Every object lives in a node of its own that never changes, and a slot holds a pointer to its node:
+/// - Searches are lock free. They probe linearly from home, comparing the hashes of the nodes before the objects,
+///   until they find the object or an empty slot.
+/// - Inserts claim an empty slot with one compare and swap, and give up their node when another thread's node for
+///   the same object is found on the way.
+/// - Resizes are cooperative. The thread that finds the table over its max load sets up a table twice the size, and
+///   every thread that inserts until it is done moves a chunk of slots over at a time. A slot is moved by copying its
+///   node over and then marking it moved, so a search that meets a moved slot goes on in the new table. An insert
+///   that meets one helps finish the resize and retries, so objects only reach the new table once it holds all of
+///   the old one. Old tables are kept until the set is destroyed, as searches may still be reading them.
+/// - The size and the collisions are counted in striped counters, one cache line per stripe, that threads are
+///   spread over and that are only added up when asked for.
+/// @tparam Key The type of object stored.
+template <typename Key = std::string>
+class ConcurrentHashSet
+{
+public:
+    /// @brief Construct an empty set.
+    /// @param size The least amount of slots of the set, rounded up to a power of two.
+    explicit ConcurrentHashSet(size_t size = 1024)
+    {
+        size_t capacity = MIN_CAPACITY;
+        while (capacity < size)
+            capacity *= 2;
+        current_.store(new Table(capacity), std::memory_order_relaxed);
+    }
+
+    ConcurrentHashSet(const ConcurrentHashSet&) = delete;
+    ConcurrentHashSet& operator=(const ConcurrentHashSet&) = delete;
+
+    /// @brief Frees every node and table. No thread may be using the set.
+    ~ConcurrentHashSet()
+    {
+        Table* table = current_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < table->capacity_; ++i)
+        {
+            Node* node = table->slots_[i].load(std::memory_order_relaxed);
+            if (node != nullptr && node != Moved())
+                delete node;
+        }
+
+        delete table;
+        for (Table* retired : retired_)
+            delete retired;
+    }
+
+    /// @brief Grows the set so a given number of objects fit without a resize. Only call it while no other thread uses
+    /// the set.
+    /// @param size The number of objects.
+    void Reserve(size_t size)
+    {
+        Table* table = current_.load(std::memory_order_acquire);
+        size_t capacity = table->capacity_;
+        while (capacity * MAX_LOAD_NUMERATOR / MAX_LOAD_DENOMINATOR < size)
+            capacity *= 2;
+
+        if (capacity > table->capacity_)
+        {
+            StartResize(table, capacity);
+            HelpResize(table);
+        }
+    }
+
+    /// @brief Insert a new object into the set.
+    /// @param x The object to insert.
+    /// @return True if the object was inserted, false if the object already exists, also when another thread inserted
+    /// it at the same time.
+    bool Insert(const Key& x)
+    {
+        size_t hash = InternalHash(x);
+        Stripe& stripe = GetStripe();
+        Node* node = nullptr;
+
+        while (true)
+        {
+            Table* table = current_.load(std::memory_order_acquire);
+            if (table->next_.load(std::memory_order_acquire) != nullptr)
+            {
+                HelpResize(table);
+                continue;
+            }
+
+            // Look for the object before making a node, so repeated objects allocate nothing.
+            size_t probes = 0;
+            Outcome outcome = Find(table, x, hash, probes);
+            if (outcome == Outcome::FOUND)
+            {
+                stripe.collisions_.fetch_add(probes - 1, std::memory_order_relaxed);
+                delete node;
+                return false;
+            }
+
+            if (outcome == Outcome::EMPTY)
+            {
+                if (node == nullptr)
+                    node = new Node{ hash, x };
+                probes = 0;
+                outcome = Claim(table, node, probes);
+                stripe.collisions_.fetch_add(probes - 1, std::memory_order_relaxed);
+                if (outcome == Outcome::EMPTY)
+                {
+                    // The count of a stripe only grows here, so its thread checks the load every so often.
+                    size_t count = stripe.size_.fetch_add(1, std::memory_order_relaxed) + 1;
+                    if (count % LOAD_CHECK_INTERVAL == 0 && GetSize() > MaxLoad(table->capacity_))
+                    {
+                        StartResize(table, table->capacity_ * 2);
+                        HelpResize(table);
+                    }
+                    return true;
+                }
+                if (outcome == Outcome::FOUND)
+                {
+                    delete node;
+                    return false;
+                }
+            }
+
+            // The table is being moved or has no empty slot left.
+            if (outcome == Outcome::FULL)
+                StartResize(table, table->capacity_ * 2);
+            HelpResize(table);
+        }
+    }
+
+    /// @brief Determine if the set contains a given object. Never waits on other threads.
+    /// @tparam K Key, or a type that compares and hashes the same, such as std::string_view for std::string.
+    /// @param x The object to search for.
+    /// @return True if the object is in the set, false otherwise.
+    template <typename K>
+    bool Contains(const K& x) const
+    {
+        size_t hash = InternalHash(x);
+        size_t probes = 0;
+        Table* table = current_.load(std::memory_order_acquire);
+        Outcome outcome;
+
+        while ((outcome = Find(table, x, hash, probes)) == Outcome::MOVED)
+            table = table->next_.load(std::memory_order_acquire);
+
+        if (probes > 1)
+            GetStripe().collisions_.fetch_add(probes - 1, std::memory_order_relaxed);
+        return outcome == Outcome::FOUND;
+    }
+
+    /// @brief Get the amount of objects in the set, exact once no thread is inserting.
+    /// @return The number of objects.
+    size_t GetSize() const
+    {
+        size_t size = 0;
+        for (auto& stripe : stripes_)
+            size += stripe.size_.load(std::memory_order_relaxed);
+        return size;
+    }
+
+    /// @brief Get the current capacity of the set.
+    /// @return The number of slots of the newest table.
+    size_t GetCapacity() const
+    {
+        Table* table = current_.load(std::memory_order_acquire);
+        Table* next = table->next_.load(std::memory_order_acquire);
+        return next != nullptr ? next->capacity_ : table->capacity_;
+    }
+
+    /// @brief Get the total amount of collisions of every insert and search so far, over every thread.
+    /// @return The number of slots probed past the first.
+    size_t GetCollisions() const
+    {
+        size_t collisions = 0;
+        for (auto& stripe : stripes_)
+            collisions += stripe.collisions_.load(std::memory_order_relaxed);
+        return collisions;
+    }
+
+    /// @brief Get the amount of times the set has grown.
+    /// @return The number of resizes.
+    size_t GetResizeCount() const
+    {
+        return resizes_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Gathers statistics of the layout of the newest table from its slots, without counting collisions. The
+    /// set has no tombstones, as objects cannot be removed. Exact once no thread is inserting, which also means no
+    /// resize is in progress.
+    /// @return The statistics, named by the caller.
+    TableDiagnostics GetDiagnostics() const
+    {
+        Table* table = current_.load(std::memory_order_acquire);
+        size_t mask = table->capacity_ - 1;
+        TableDiagnostics diagnostics;
+        diagnostics.capacity_ = table->capacity_;
+        std::vector<size_t> homes(table->capacity_, 0);
+
+        for (size_t i = 0; i < table->capacity_; ++i)
+        {
+            Node* node = table->slots_[i].load(std::memory_order_acquire);
+            if (node == nullptr || node == Moved())
+                continue;
+
+            // Linear probing from home, so a search for the node probes every slot up to its own.
+            size_t home = node->hash_ & mask;
+            ++diagnostics.size_;
+            diagnostics.AddProbes(((i - home) & mask) + 1);
+            ++homes[home];
+        }
+
+        diagnostics.AddRuns(table->capacity_, [table](size_t i)
+        {
+            Node* node = table->slots_[i].load(std::memory_order_acquire);
+            return node != nullptr && node != Moved();
+        });
+        diagnostics.SetHomes(homes);
+        return diagnostics;
+    }
+
+private:
+    static const size_t MIN_CAPACITY = 64;
+    static const size_t MAX_LOAD_NUMERATOR = 1;     // Max load factor of one half
+    static const size_t MAX_LOAD_DENOMINATOR = 2;
+    static const size_t LOAD_CHECK_INTERVAL = 16;   // Inserts of a stripe between checks of the load
+    static const size_t MOVE_CHUNK = 1024;          // Slots moved by a thread at a time during a resize
+    static const size_t STRIPES = 16;
+
+    struct Node
+    {
+        size_t hash_;
+        Key element_;
+    };
+
+    struct Table
+    {
+        explicit Table(size_t capacity) : capacity_(capacity), slots_(new std::atomic<Node*>[capacity])
+        {
+            for (size_t i = 0; i < capacity; ++i)
+                slots_[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        ~Table()
+        {
+            delete[] slots_;
+        }
+
+        const size_t capacity_;                     // A power of two
+        std::atomic<Node*>* slots_;
+        std::atomic<Table*> next_{ nullptr };       // The table being moved into
+        std::atomic<size_t> next_chunk_{ 0 };       // The next chunk of slots a thread may claim to move
+        std::atomic<size_t> chunks_done_{ 0 };
+    };
+
+    struct alignas(64) Stripe
+    {
+        std::atomic<size_t> size_{ 0 };
+        std::atomic<size_t> collisions_{ 0 };
+    };
+
+    enum class Outcome
+    {
+        FOUND,      // The object is in the table
+        EMPTY,      // The object is not in the table, or was stored by Claim
+        MOVED,      // The search met a slot moved to the next table
+        FULL        // Every slot holds another object
+    };
+
+    std::atomic<Table*> current_;
+    mutable Stripe stripes_[STRIPES];
+    std::atomic<size_t> resizes_{ 0 };
+    std::mutex retired_mutex_;
+    std::vector<Table*> retired_;               // Tables moved out of, freed with the set
+
+    /// @brief Gets the marker of a moved slot, a node no table holds.
+    static Node* Moved()
+    {
+        static Node moved{ 0, Key{ } };
+        return &moved;
+    }
+
+    static size_t MaxLoad(size_t capacity)
+    {
+        return capacity * MAX_LOAD_NUMERATOR / MAX_LOAD_DENOMINATOR;
+    }
+
+    /// @brief Gets the stripe of the counters of the calling thread. Threads take stripes in turn as they first count.
+    Stripe& GetStripe() const
+    {
+        static std::atomic<size_t> next_thread{ 0 };
+        thread_local size_t stripe = next_thread.fetch_add(1, std::memory_order_relaxed) % STRIPES;
+        return stripes_[stripe];
+    }
+
+    /// @brief Hash function, mixed so the low bits that pick the home slot depend on every bit of the hash.
+    template <typename K>
+    static size_t InternalHash(const K& x)
+    {
+        static std::hash<K> hf;
+        return MixHash(hf(x));
+    }
+
+    /// @brief Searches one table for an object.
+    /// @param table The table.
+    /// @param x The object to search for.
+    /// @param hash The hash of the object.
+    /// @param probes Increased by the number of slots read.
+    /// @return FOUND, EMPTY when the search reached an empty slot, MOVED or FULL.
+    template <typename K>
+    static Outcome Find(const Table* table, const K& x, size_t hash, size_t& probes)
+    {
+        size_t mask = table->capacity_ - 1;
+        size_t pos = hash & mask;
+        for (size_t i = 0; i < table->capacity_; ++i, pos = (pos + 1) & mask)
+        {
+            ++probes;
+            Node* node = table->slots_[pos].load(std::memory_order_acquire);
+            if (node == nullptr)
+                return Outcome::EMPTY;
+            if (node == Moved())
+                return Outcome::MOVED;
+            if (node->hash_ == hash && node->element_ == x)
+                return Outcome::FOUND;
+        }
+
+        return Outcome::FULL;
+    }
+
+    /// @brief Stores a node in the first empty slot of its probe sequence, unless the sequence reaches the object first.
+    /// @param table The table.
+    /// @param node The node to store.
+    /// @param probes Increased by the number of slots read.
+    /// @return EMPTY if the node was stored, FOUND, MOVED or FULL.
+    static Outcome Claim(Table* table, Node* node, size_t& probes)
+    {
+        size_t mask = table->capacity_ - 1;
+        size_t pos = node->hash_ & mask;
+        for (size_t i = 0; i < table->capacity_; ++i, pos = (pos + 1) & mask)
+        {
+            ++probes;
+            Node* current = table->slots_[pos].load(std::memory_order_acquire);
+
+            // A lost race for an empty slot leaves the winner's node in it, which is checked like any other.
+            if (current == nullptr
+                && table->slots_[pos].compare_exchange_strong(current, node, std::memory_order_acq_rel))
+                return Outcome::EMPTY;
+            if (current == Moved())
+                return Outcome::MOVED;
+            if (current->hash_ == node->hash_ && current->element_ == node->element_)
+                return Outcome::FOUND;
+        }
+
+        return Outcome::FULL;
+    }
+
+    /// @brief Sets up the table to move a table into, unless another thread already has.
+    /// @param table The table to move out of.
+    /// @param capacity The capacity of the new table.
+    void StartResize(Table* table, size_t capacity)
+    {
+        if (table->next_.load(std::memory_order_acquire) != nullptr)
+            return;
+
+        Table* next = new Table(capacity);
+        Table* expected = nullptr;
+        if (!table->next_.compare_exchange_strong(expected, next, std::memory_order_acq_rel))
+            delete next;
+    }
+
+    /// @brief Moves chunks of a table into its next table until none are left, waits for the chunks other threads
+    /// took, and makes the next table current.
+    /// @param table The table being moved out of.
+    void HelpResize(Table* table)
+    {
+        Table* next = table->next_.load(std::memory_order_acquire);
+        if (next == nullptr)
+            return;
+
+        size_t chunks = (table->capacity_ + MOVE_CHUNK - 1) / MOVE_CHUNK;
+        size_t chunk;
+        while ((chunk = table->next_chunk_.fetch_add(1, std::memory_order_relaxed)) < chunks)
+        {
+            size_t end = std::min(table->capacity_, (chunk + 1) * MOVE_CHUNK);
+            for (size_t i = chunk * MOVE_CHUNK; i < end; ++i)
+                MoveSlot(table, next, i);
+            table->chunks_done_.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+        while (table->chunks_done_.load(std::memory_order_acquire) < chunks)
+            std::this_thread::yield();
+
+        Table* expected = table;
+        if (current_.compare_exchange_strong(expected, next, std::memory_order_acq_rel))
+        {
+            resizes_.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(retired_mutex_);
+            retired_.push_back(table);
+        }
+    }
+
+    /// @brief Moves one slot of a table into its next table and marks it moved. Only the thread that claimed the
+    /// chunk of the slot moves it, but inserts may still fill it while it is empty.
+    static void MoveSlot(Table* table, Table* next, size_t i)
+    {
+        Node* node = table->slots_[i].load(std::memory_order_acquire);
+        while (node == nullptr)
+        {
+            if (table->slots_[i].compare_exchange_strong(node, Moved(), std::memory_order_acq_rel))
+                return;
+        }
+
+        // Objects of a table are unique and nothing else is inserted into the next table yet.
+        size_t mask = next->capacity_ - 1;
+        size_t pos = node->hash_ & mask;
+        Node* empty = nullptr;
+        while (!next->slots_[pos].compare_exchange_strong(empty, node, std::memory_order_acq_rel))
+        {
+            empty = nullptr;
+            pos = (pos + 1) & mask;
+        }
+
+        table->slots_[i].store(Moved(), std::memory_order_release);
+    }
+};
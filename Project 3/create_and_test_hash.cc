@@ -1,16 +1,22 @@
 // Youssef Elshabasy
+#include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
 
+#include "concurrent_hash_set.h"
 #include "linear_probing.h"
 #include "double_hashing.h"
 #include "quadratic_probing.h"
+#include "robin_hood_hashing.h"
+#include "swiss_table.h"
 using namespace std;
 
 /// @brief Series of tests to display information about the hash table.
 /// @tparam HashTableType The type of hash table to test.
-/// @param hash_table The hash table to test (can be linear, quadratic, or double).
+/// @param hash_table The hash table to test (can be linear, quadratic, double, swiss, or robinhood).
 /// @param words_filename The filename of input words to construct the hash table.
 /// @param query_filename The filename of input words to test the hash table.
 template <typename HashTableType>
@@ -47,7 +53,199 @@ void TestFunctionForHashTable(HashTableType& hash_table, const string& words_fil
     queryFile.close();
 }
 
-/// @brief Wrapper function to call the specific testing function for hash table (linear, quadratic, or double).
+/// @brief Sets the R value of a double hashing table, other tables have none.
+template <typename HashTableType>
+void SetRValueIfDouble(HashTableType&, int)
+{ }
+
+template <typename HashPolicy, typename Layout>
+void SetRValueIfDouble(OpenAddressingTable<string, DoubleHashing, HashPolicy, Layout>& hash_table, int R)
+{
+    hash_table.SetRValue(R);
+}
+
+/// @brief Builds a hash table of every word and searches it for every query, printing one row of the sweep.
+/// @tparam HashTableType The type of hash table to test.
+/// @param name The probing, hash and layout of the hash table, for the report.
+/// @param R The R value of double hashing, unused by other tables.
+/// @param words The words to construct the hash table.
+/// @param queries The words to search for.
+template <typename HashTableType>
+void SweepHashTable(const string& name, int R, const vector<string>& words, const vector<string>& queries)
+{
+    using Clock = chrono::steady_clock;
+
+    HashTableType hash_table;
+    SetRValueIfDouble(hash_table, R);
+
+    Clock::time_point start = Clock::now();
+    for (auto& word : words)
+        hash_table.Insert(word);
+    Clock::time_point middle = Clock::now();
+
+    size_t found = 0;
+    for (auto& query : queries)
+        found += hash_table.Contains(query);
+    Clock::time_point end = Clock::now();
+
+    size_t probes = 0;
+    for (auto& query : queries)
+        probes += hash_table.GetProbes(query);
+
+    printf("%-30s %10zu %9zu %12zu %10.3f %10zu %10.1f %10.1f\n", name.c_str(), hash_table.GetCapacity(), hash_table.GetRehashCount(), hash_table.GetTotalCollisions(),
+        queries.empty() ? 0 : (double)probes / queries.size(), found,
+        words.empty() ? 0 : chrono::duration<double, nano>(middle - start).count() / words.size(),
+        queries.empty() ? 0 : chrono::duration<double, nano>(end - middle).count() / queries.size());
+}
+
+/// @brief Sweeps every layout of a probing and hash policy.
+template <typename ProbePolicy, typename HashPolicy>
+void SweepLayouts(const string& name, int R, const vector<string>& words, const vector<string>& queries)
+{
+    SweepHashTable<OpenAddressingTable<string, ProbePolicy, HashPolicy, InlineLayout>>(name + "/inline", R, words, queries);
+    SweepHashTable<OpenAddressingTable<string, ProbePolicy, HashPolicy, SplitLayout>>(name + "/split", R, words, queries);
+    SweepHashTable<OpenAddressingTable<string, ProbePolicy, HashPolicy, ArenaLayout>>(name + "/arena", R, words, queries);
+}
+
+/// @brief Sweeps every hash policy and layout of a probing policy.
+template <typename ProbePolicy>
+void SweepHashes(const string& name, int R, const vector<string>& words, const vector<string>& queries)
+{
+    SweepLayouts<ProbePolicy, PrimeCapacity>(name + "/prime", R, words, queries);
+    SweepLayouts<ProbePolicy, PowerOfTwoCapacity>(name + "/mask", R, words, queries);
+    SweepLayouts<ProbePolicy, FastRangeCapacity>(name + "/fastrange", R, words, queries);
+}
+
+/// @brief Runs every combination of probing, hash and layout policy of OpenAddressingTable on the same words.
+/// @param words_filename The filename of input words to construct the hash tables.
+/// @param query_filename The filename of input words to search the hash tables for.
+/// @param R The R value of double hashing.
+void SweepHashTables(const string& words_filename, const string& query_filename, int R)
+{
+    vector<string> words, queries;
+    string line;
+
+    ifstream wordsFile(words_filename);
+    while (wordsFile >> line)
+        words.push_back(line);
+
+    ifstream queryFile(query_filename);
+    while (queryFile >> line)
+        queries.push_back(line);
+
+    printf("%-30s %10s %9s %12s %10s %10s %10s %10s\n", "probing/hash/layout", "capacity", "rehashes", "collisions", "avg_probes", "found", "insert_ns", "search_ns");
+    SweepHashes<LinearProbing>("linear", R, words, queries);
+    SweepHashes<QuadraticProbing>("quadratic", R, words, queries);
+    SweepHashes<DoubleHashing>("double", R, words, queries);
+    SweepHashes<RobinHoodProbing>("robinhood", R, words, queries);
+}
+
+/// @brief Reads every word of a file.
+/// @param filename The file.
+/// @return The words.
+vector<string> ReadWords(const string& filename)
+{
+    vector<string> words;
+    string line;
+    ifstream file(filename);
+    while (file >> line)
+        words.push_back(line);
+    return words;
+}
+
+/// @brief Diagnoses a hash table of every word, then again once every query is removed from it.
+/// @tparam HashTableType The type of hash table to diagnose.
+/// @param name The name of the hash table, for the report.
+/// @param R The R value of double hashing, unused by other tables.
+/// @param words The words to construct the hash table.
+/// @param queries The words to remove.
+/// @param report The diagnostics to add both to.
+template <typename HashTableType>
+void DiagnoseHashTable(const string& name, int R, const vector<string>& words, const vector<string>& queries, vector<TableDiagnostics>& report)
+{
+    HashTableType hash_table;
+    SetRValueIfDouble(hash_table, R);
+    for (auto& word : words)
+        hash_table.Insert(word);
+
+    report.push_back(hash_table.GetDiagnostics());
+    report.back().name_ = name;
+
+    for (auto& query : queries)
+        hash_table.Remove(query);
+
+    report.push_back(hash_table.GetDiagnostics());
+    report.back().name_ = name + "/removed";
+}
+
+/// @brief Prints the probe length, tombstone, clustering and hash quality diagnostics of every hash table.
+/// @param words_filename The filename of input words to construct the hash tables.
+/// @param query_filename The filename of input words to remove from the hash tables.
+/// @param R The R value of double hashing.
+/// @param json True to print a JSON array, false to print CSV.
+void DiagnoseHashTables(const string& words_filename, const string& query_filename, int R, bool json)
+{
+    vector<string> words = ReadWords(words_filename);
+    vector<string> queries = ReadWords(query_filename);
+
+    vector<TableDiagnostics> report;
+    DiagnoseHashTable<HashTableLinear<string>>("linear", R, words, queries, report);
+    DiagnoseHashTable<HashTable<string>>("quadratic", R, words, queries, report);
+    DiagnoseHashTable<HashTableDouble<string>>("double/r=" + to_string(R), R, words, queries, report);
+    DiagnoseHashTable<HashTableRobinHood<string>>("robinhood", R, words, queries, report);
+    DiagnoseHashTable<HashTableSwiss<string>>("swiss", R, words, queries, report);
+
+    // Objects cannot be removed from the concurrent set, so it is only diagnosed once built.
+    ConcurrentHashSet<string> concurrent;
+    for (auto& word : words)
+        concurrent.Insert(word);
+    report.push_back(concurrent.GetDiagnostics());
+    report.back().name_ = "concurrent";
+
+    if (json)
+    {
+        cout << "[" << endl;
+        for (size_t i = 0; i < report.size(); ++i)
+            cout << "  " << report[i].ToJson() << (i + 1 < report.size() ? "," : "") << endl;
+        cout << "]" << endl;
+    }
+    else
+    {
+        cout << TableDiagnostics::CsvHeader() << endl;
+        for (auto& diagnostics : report)
+            cout << diagnostics.ToCsv() << endl;
+    }
+}
+
+/// @brief Compares double hashing with a given R against R tuned to the words, both once the table is built and at
+/// every rehash while it is built.
+/// @param words_filename The filename of input words to construct the hash tables.
+/// @param R The R value to compare against.
+void TuneDoubleHashing(const string& words_filename, int R)
+{
+    vector<string> words = ReadWords(words_filename);
+
+    HashTableDouble<string> manual_table;
+    manual_table.SetRValue(R);
+    for (auto& word : words)
+        manual_table.Insert(word);
+    printf("%-10s %8s %12s\n", "r", "r_value", "mean_probes");
+    printf("%-10s %8d %12.4f\n", "manual", manual_table.GetRValue(), manual_table.GetDiagnostics().GetMeanProbes());
+
+    manual_table.TuneRValue();
+    printf("%-10s %8d %12.4f\n", "retuned", manual_table.GetRValue(), manual_table.GetDiagnostics().GetMeanProbes());
+
+    HashTableDouble<string> tuned_table;
+    for (auto& word : words)
+        tuned_table.Insert(word);
+    printf("%-10s %8d %12.4f\n", "tuned", tuned_table.GetRValue(), tuned_table.GetDiagnostics().GetMeanProbes());
+
+    cout << endl;
+    printf("expected_gain: %.4f mean probes (%.1f%%) over R = %d\n", manual_table.GetPreviousProbes() - manual_table.GetExpectedProbes(),
+        100 * (1 - manual_table.GetExpectedProbes() / manual_table.GetPreviousProbes()), R);
+}
+
+/// @brief Wrapper function to call the specific testing function for hash table (linear, quadratic, double, swiss, or robinhood).
 /// @param argument_count argc as provided in main.
 /// @param argument_list argv as provided in main.
 /// @return 0 if successful.
@@ -80,10 +278,33 @@ int testHashingWrapper(int argument_count, char** argument_list)
         double_probing_table.SetRValue(R);
         TestFunctionForHashTable(double_probing_table, words_filename, query_filename);
     }
+    else if (param_flag == "swiss")
+    {
+        HashTableSwiss<string> swiss_table;
+        TestFunctionForHashTable(swiss_table, words_filename, query_filename);
+    }
+    else if (param_flag == "robinhood")
+    {
+        HashTableRobinHood<string> robin_hood_table;
+        TestFunctionForHashTable(robin_hood_table, words_filename, query_filename);
+    }
+    else if (param_flag == "sweep")
+    {
+        cout << "r_value: " << R << endl;
+        SweepHashTables(words_filename, query_filename, R);
+    }
+    else if (param_flag == "tune")
+    {
+        TuneDoubleHashing(words_filename, R);
+    }
+    else if (param_flag == "csv" || param_flag == "json")
+    {
+        DiagnoseHashTables(words_filename, query_filename, R, param_flag == "json");
+    }
     else
     {
         cout << "Unknown tree type " << param_flag
-            << " (User should provide linear, quadratic, or double)" << endl;
+            << " (User should provide linear, quadratic, double, swiss, robinhood, sweep, tune, csv, or json)" << endl;
     }
     return 0;
 }
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "capacity_policy.h"
+
+/// @brief Index of the single character deletions of every word of a dictionary, in the style of SymSpell. A word
+/// with one letter inserted is in the dictionary exactly when it is one of the deletions of a dictionary word, so the
+/// insertions that make a word correct come from one search of the index instead of a dictionary search for every
+/// letter at every position.
+/// Deletions are not stored as strings: each entry is the dictionary word and the position deleted, filed under the
+/// hash of the deletion. Entries sit in one array ordered by bucket, with the start of every bucket in another, and a
+/// search checks each entry of its bucket against the word by comparing it with the dictionary word around the gap.
+/// Only deletions of the letters a to z are indexed, the letters the spell checker inserts.
+class DeletionIndex
+{
+public:
+    /// @brief Builds the index from a list of words, replacing what it held. Repeated words are kept once.
+    /// @param words The words of the dictionary.
+    void Build(const std::vector<std::string>& words)
+    {
+        std::vector<std::string_view> keys(words.begin(), words.end());
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        chars_.clear();
+        word_offsets_.assign(1, 0);
+        for (auto& key : keys)
+        {
+            chars_.append(key.data(), key.size());
+            word_offsets_.push_back(static_cast<uint32_t>(chars_.size()));
+        }
+
+        // Hash every deletion once, then place the entries bucket by bucket.
+        std::vector<std::pair<uint64_t, Entry>> deletions;
+        for (uint32_t word = 0; word < keys.size(); ++word)
+            for (size_t position = 0; position < keys[word].size() && position <= UINT16_MAX; ++position)
+                if (keys[word][position] >= 'a' && keys[word][position] <= 'z')
+                {
+                    uint64_t hash = HashDeletion(keys[word], position);
+                    deletions.emplace_back(hash, Entry{ word, static_cast<uint16_t>(position), TagOf(hash) });
+                }
+
+        bucket_bits_ = 1;
+        while ((size_t(1) << bucket_bits_) < deletions.size())
+            ++bucket_bits_;
+
+        bucket_starts_.assign((size_t(1) << bucket_bits_) + 1, 0);
+        for (auto& deletion : deletions)
+            ++bucket_starts_[BucketOf(deletion.first) + 1];
+        for (size_t bucket = 1; bucket < bucket_starts_.size(); ++bucket)
+            bucket_starts_[bucket] += bucket_starts_[bucket - 1];
+
+        entries_.resize(deletions.size());
+        std::vector<uint32_t> next(bucket_starts_.begin(), bucket_starts_.end() - 1);
+        for (auto& deletion : deletions)
+            entries_[next[BucketOf(deletion.first)]++] = deletion.second;
+    }
+
+    /// @brief Finds every letter from a to z that, inserted somewhere into a word, makes a dictionary word.
+    /// @param x The word.
+    /// @return The positions and letters of the insertions, sorted by position and then letter.
+    std::vector<std::pair<size_t, char>> Insertions(std::string_view x) const
+    {
+        std::vector<std::pair<size_t, char>> insertions;
+        if (entries_.empty())
+            return insertions;
+
+        uint64_t hash = HashWord(x);
+        size_t bucket = BucketOf(hash);
+        uint16_t tag = TagOf(hash);
+        for (uint32_t i = bucket_starts_[bucket]; i < bucket_starts_[bucket + 1]; ++i)
+        {
+            const Entry& entry = entries_[i];
+            if (entry.tag_ != tag)
+                continue;
+
+            std::string_view word = Word(entry.word_);
+            size_t position = entry.position_;
+            if (word.size() == x.size() + 1 && word.compare(0, position, x, 0, position) == 0
+                && word.compare(position + 1, std::string_view::npos, x, position, std::string_view::npos) == 0)
+                insertions.emplace_back(position, word[position]);
+        }
+
+        std::sort(insertions.begin(), insertions.end());
+        return insertions;
+    }
+
+    /// @brief Get the amount of deletions indexed.
+    /// @return The number of entries.
+    size_t GetEntryCount() const
+    {
+        return entries_.size();
+    }
+
+    /// @brief Get the size of the index.
+    /// @return The number of bytes of the entries, the buckets and the words.
+    size_t GetBytes() const
+    {
+        return entries_.size() * sizeof(Entry) + bucket_starts_.size() * sizeof(uint32_t)
+            + word_offsets_.size() * sizeof(uint32_t) + chars_.size();
+    }
+
+private:
+    /// @brief A deletion: the dictionary word, the position of the letter deleted, and bits of the hash to skip most
+    /// entries of the bucket that belong to other deletions without comparing them.
+    struct Entry
+    {
+        uint32_t word_;
+        uint16_t position_;
+        uint16_t tag_;
+    };
+
+    std::string chars_;                     // The characters of every word, back to back
+    std::vector<uint32_t> word_offsets_;    // Where every word starts in chars_, and where the last one ends
+    std::vector<Entry> entries_;            // Entries ordered by bucket
+    std::vector<uint32_t> bucket_starts_;   // The first entry of every bucket, and the end of the last
+    size_t bucket_bits_ = 0;
+
+    std::string_view Word(uint32_t word) const
+    {
+        return std::string_view(chars_.data() + word_offsets_[word], word_offsets_[word + 1] - word_offsets_[word]);
+    }
+
+    size_t BucketOf(uint64_t hash) const
+    {
+        return static_cast<size_t>(hash >> (64 - bucket_bits_));
+    }
+
+    static uint16_t TagOf(uint64_t hash)
+    {
+        return static_cast<uint16_t>(hash);
+    }
+
+    /// @brief Hashes a word, FNV-1a over its characters followed by the MurmurHash3 finalizer.
+    static uint64_t HashWord(std::string_view x)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (unsigned char c : x)
+            hash = (hash ^ c) * 0x100000001b3ull;
+        return MixHash(hash);
+    }
+
+    /// @brief Hashes a word with one character deleted, as HashWord hashes the shorter word.
+    static uint64_t HashDeletion(std::string_view x, size_t position)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (size_t i = 0; i < x.size(); ++i)
+            if (i != position)
+                hash = (hash ^ static_cast<unsigned char>(x[i])) * 0x100000001b3ull;
+        return MixHash(hash);
+    }
+};
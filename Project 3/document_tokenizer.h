@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/// @brief Splits the raw bytes of a document into the words the spell checker checks: runs of bytes between
+/// whitespace, lowercased, with one punctuation mark dropped from either end. Runs that are nothing but punctuation
+/// are skipped. Every byte is classified and lowercased through one table lookup, in the C locale, and each word is
+/// lowercased into a buffer the tokenizer reuses, so no word is allocated on its own.
+class DocumentTokenizer
+{
+public:
+    /// @brief Construct a tokenizer over some text.
+    /// @param text The text, which must outlive the tokenizer.
+    explicit DocumentTokenizer(std::string_view text = std::string_view()) : text_(text)
+    { }
+
+    /// @brief Starts over on other text, keeping the buffer.
+    /// @param text The text, which must outlive the tokenizer.
+    void Reset(std::string_view text)
+    {
+        text_ = text;
+        pos_ = 0;
+    }
+
+    /// @brief Finds the next word of the text.
+    /// @param word Set to the lowercased word, valid until the next call.
+    /// @return True if there was another word, false at the end of the text.
+    bool Next(std::string_view& word)
+    {
+        const Table& table = GetTable();
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(text_.data());
+        size_t size = text_.size();
+
+        while (pos_ < size)
+        {
+            while (pos_ < size && table.class_[bytes[pos_]] == SPACE)
+                ++pos_;
+            size_t begin = pos_;
+            while (pos_ < size && table.class_[bytes[pos_]] != SPACE)
+                ++pos_;
+            size_t end = pos_;
+
+            if (begin < end && table.class_[bytes[begin]] == MARK)
+                ++begin;
+            if (begin < end && table.class_[bytes[end - 1]] == MARK)
+                --end;
+            if (begin == end)
+                continue;
+
+            buffer_.resize(end - begin);
+            for (size_t i = begin; i < end; ++i)
+                buffer_[i - begin] = table.lower_[bytes[i]];
+            word = buffer_;
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+    enum CharClass : uint8_t
+    {
+        SPACE,      // Separates words
+        ALNUM,      // A letter or digit
+        MARK        // Anything else, such as punctuation
+    };
+
+    struct Table
+    {
+        CharClass class_[256];
+        char lower_[256];
+    };
+
+    std::string_view text_;
+    size_t pos_ = 0;
+    std::string buffer_;
+
+    /// @brief Gets the class and the lowercase of every byte, built on first use.
+    static const Table& GetTable()
+    {
+        static const Table table = []
+        {
+            Table t;
+            for (int c = 0; c < 256; ++c)
+            {
+                bool space = c == ' ' || (c >= '\t' && c <= '\r');
+                bool alnum = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+                t.class_[c] = space ? SPACE : alnum ? ALNUM : MARK;
+                t.lower_[c] = static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+            }
+            return t;
+        }();
+        return table;
+    }
+};
@@ -0,0 +1,1282 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "capacity_policy.h"
+#include "table_diagnostics.h"
+
+/// @brief The state of a slot of an OpenAddressingTable.
+enum class SlotState : uint8_t { ACTIVE, EMPTY, DELETED };
+
+
+/// @brief Probe policy of linear probing: every probe moves one slot on.
+struct LinearProbing
+{
+    static const bool ROBIN_HOOD = false;
+
+    /// @brief Gets the highest max load factor the probing allows, past it runs get too long.
+    /// @return The highest max load factor.
+    static double MaxLoadFactor()
+    {
+        return 0.75;
+    }
+
+    /// @brief Gets the step from the home slot to the second probe.
+    /// @tparam HashPolicy The capacity policy of the table.
+    /// @param hash The hash of the object.
+    /// @param capacity The number of slots.
+    /// @return The first step.
+    template <typename HashPolicy>
+    size_t FirstStep(size_t hash, size_t capacity) const
+    {
+        return 1;
+    }
+
+    /// @brief Gets the step of the probe after the one a step led to.
+    /// @tparam HashPolicy The capacity policy of the table.
+    /// @param step The last step.
+    /// @return The next step.
+    template <typename HashPolicy>
+    size_t NextStep(size_t step) const
+    {
+        return step;
+    }
+
+    /// @brief Whether the probing tunes itself to the objects at every rehash, only double hashing can.
+    /// @return False, linear probing has nothing to tune.
+    bool IsTuned() const
+    {
+        return false;
+    }
+
+    /// @brief Tunes the probing to the objects about to be moved into an array.
+    /// @tparam HashPolicy The capacity policy of the table.
+    /// @param hashes The hashes of the objects.
+    /// @param capacity The number of slots of the array.
+    template <typename HashPolicy>
+    void Tune(const std::vector<size_t>& hashes, size_t capacity)
+    { }
+};
+
+/// @brief Probe policy of quadratic probing: every step is longer than the last, by 2 for prime capacities so the
+/// probes are i^2 slots past home, and by 1 for power of two capacities so they are triangular numbers.
+struct QuadraticProbing : LinearProbing
+{
+    /// @brief Gets the highest max load factor the probing allows, i^2 probes of a prime table only reach a free slot
+    /// for certain up to half load.
+    /// @return The highest max load factor.
+    static double MaxLoadFactor()
+    {
+        return 0.5;
+    }
+
+    /// @brief Gets the step of the probe after the one a step led to.
+    /// @tparam HashPolicy The capacity policy of the table.
+    /// @param step The last step.
+    /// @return The next step.
+    template <typename HashPolicy>
+    size_t NextStep(size_t step) const
+    {
+        return step + HashPolicy::QUADRATIC_OFFSET_STEP;
+    }
+};
+
+/// @brief Probe policy of double hashing: every probe moves R - (hash % R) slots on. R is either set by the user, or
+/// tuned: at every rehash, the objects are replayed into an array of the new capacity with each of a few prime R
+/// below it, and the R with the fewest probes on average is kept.
+struct DoubleHashing : LinearProbing
+{
+    static const size_t TUNE_CANDIDATES = 8;    // R values replayed by each tuning, so a rehash stays linear
+
+    int R = 0;                      // 0 until tuned or set
+    bool tuned_ = true;             // Whether R is chosen at every rehash
+    double expected_probes_ = 0;    // Mean probes of the objects with R, as of the last tuning
+    double previous_probes_ = 0;    // Mean probes of the same objects with the R before it
+
+    /// @brief Sets a value that will be used for the double hashing computation
+    /// @param R The value to use for the double hashing computation, 0 or less to tune it at every rehash instead.
+    void SetRValue(int R)
+    {
+        tuned_ = R <= 0;
+        if (!tuned_)
+            this->R = R;
+    }
+
+    /// @brief Gets the step from the home slot to the second probe.
+    /// @tparam HashPolicy The capacity policy of the table.
+    /// @param hash The hash of the object.
+    /// @param capacity The number of slots.
+    /// @return The step every probe of the object moves by, never 0 even for an R past the capacity.
+    template <typename HashPolicy>
+    size_t FirstStep(size_t hash, size_t capacity) const
+    {
+        size_t step = HashPolicy::Step(R - hash % R, capacity);
+        return step + (step == 0);
+    }
+
+    bool IsTuned() const
+    {
+        return tuned_;
+    }
+
+    /// @brief Picks the prime R below the capacity that gives the objects the fewest probes on average. Candidates
+    /// are the largest prime below the capacity and below each of the largest powers of two under it, at most
+    /// TUNE_CANDIDATES in all, so tuning replays the objects a fixed number of times whatever the capacity.
+    /// @tparam HashPolicy The capacity policy of the table.
+    /// @param hashes The hashes of the objects, in the order they will be moved in.
+    /// @param capacity The number of slots of the array they will be moved into.
+    template <typename HashPolicy>
+    void Tune(const std::vector<size_t>& hashes, size_t capacity)
+    {
+        // Largest first, down from the largest power of two below the capacity.
+        std::vector<size_t> candidates{ PrevPrime(capacity - 1) };
+        size_t bound = 4;
+        while (bound * 2 < capacity)
+            bound *= 2;
+        for (; bound >= 4 && bound < capacity && candidates.size() < TUNE_CANDIDATES; bound /= 2)
+            candidates.push_back(PrevPrime(bound - 1));
+
+        previous_probes_ = R > 0 ? MeanProbes<HashPolicy>(hashes, capacity, R) : 0;
+        expected_probes_ = 0;
+        std::vector<uint8_t> taken;
+        for (size_t i = 0; i < candidates.size(); ++i)
+        {
+            // The largest R goes first and wins ties, so an empty table gets the textbook choice.
+            double probes = MeanProbes<HashPolicy>(hashes, capacity, candidates[i], taken);
+            if (i == 0 || probes < expected_probes_)
+            {
+                R = static_cast<int>(candidates[i]);
+                expected_probes_ = probes;
+            }
+        }
+        if (previous_probes_ == 0)
+            previous_probes_ = expected_probes_;
+    }
+
+private:
+    /// @brief Replays objects into an empty array with a given R.
+    /// @param taken Scratch space for which slots are taken, reused between replays.
+    /// @return The mean probes of a search for each object, 0 without objects.
+    template <typename HashPolicy>
+    static double MeanProbes(const std::vector<size_t>& hashes, size_t capacity, size_t R, std::vector<uint8_t>& taken)
+    {
+        DoubleHashing probe;
+        probe.R = static_cast<int>(R);
+        taken.assign(capacity, 0);
+
+        size_t probes = 0;
+        for (size_t hash : hashes)
+        {
+            size_t step = probe.FirstStep<HashPolicy>(hash, capacity);
+            size_t current_pos = HashPolicy::Reduce(hash, capacity);
+            for (++probes; taken[current_pos]; ++probes)
+            {
+                current_pos += step;
+                if (current_pos >= capacity)
+                    current_pos -= capacity;
+            }
+            taken[current_pos] = 1;
+        }
+        return hashes.empty() ? 0 : (double)probes / hashes.size();
+    }
+
+    template <typename HashPolicy>
+    static double MeanProbes(const std::vector<size_t>& hashes, size_t capacity, size_t R)
+    {
+        std::vector<uint8_t> taken;
+        return MeanProbes<HashPolicy>(hashes, capacity, R, taken);
+    }
+
+    /// @brief Gets the largest prime at most n, or 2 if there is none.
+    static size_t PrevPrime(size_t n)
+    {
+        for (; n > 2; --n)
+        {
+            bool prime = n % 2 != 0;
+            for (size_t d = 3; prime && d * d <= n; d += 2)
+                prime = n % d != 0;
+            if (prime)
+                return n;
+        }
+        return 2;
+    }
+};
+
+/// @brief Probe policy of Robin Hood linear probing. An insert takes the slot of any object closer to home than itself
+/// and carries that object on, a search stops at the first object closer to home than the search has come, and a
+/// removal shifts the rest of the run back one slot instead of leaving a tombstone.
+struct RobinHoodProbing : LinearProbing
+{
+    static const bool ROBIN_HOOD = true;
+
+    /// @brief Gets the highest max load factor the probing allows, evening out the distances keeps runs short longer.
+    /// @return The highest max load factor.
+    static double MaxLoadFactor()
+    {
+        return 0.875;
+    }
+};
+
+
+/// @brief Layout that keeps each object in one array with its hash and state.
+struct InlineLayout
+{
+    /// @brief The slots of one array of a table.
+    /// @tparam Key The type of object stored.
+    template <typename Key>
+    class Storage
+    {
+    public:
+        using Payload = Key;    // What a slot holds for its object
+
+        /// @brief Construct an array of empty slots.
+        /// @param size The number of slots.
+        explicit Storage(size_t size = 0) : entries_(size)
+        { }
+
+        size_t Size() const { return entries_.size(); }
+        SlotState State(size_t i) const { return entries_[i].info_; }
+        void SetState(size_t i, SlotState state) { entries_[i].info_ = state; }
+        size_t Hash(size_t i) const { return entries_[i].hash_; }
+        const Key& Element(size_t i) const { return entries_[i].element_; }
+        Payload Take(size_t i) { return std::move(entries_[i].element_); }
+        void Prefetch(size_t i) const { __builtin_prefetch(&entries_[i]); }
+
+        /// @brief Makes the payload of an object about to be stored.
+        template <typename K>
+        Payload MakePayload(K&& x) { return Payload(std::forward<K>(x)); }
+
+        /// @brief Checks an object against a slot, comparing the hashes before the objects.
+        /// @return True if the slot holds the object, whatever its state, false otherwise.
+        template <typename K>
+        bool Matches(size_t i, const K& x, size_t hash) const
+        {
+            return entries_[i].hash_ == hash && entries_[i].element_ == x;
+        }
+
+        /// @brief Stores an active object in a slot.
+        template <typename K>
+        void Set(size_t i, K&& x, size_t hash)
+        {
+            entries_[i].element_ = std::forward<K>(x);
+            entries_[i].hash_ = hash;
+            entries_[i].info_ = SlotState::ACTIVE;
+        }
+
+        /// @brief Swaps the object of an active slot with an object being carried.
+        void Swap(size_t i, Payload& x, size_t& hash)
+        {
+            std::swap(entries_[i].element_, x);
+            std::swap(entries_[i].hash_, hash);
+        }
+
+        /// @brief Moves a slot onto another.
+        void Move(size_t to, size_t from)
+        {
+            entries_[to] = std::move(entries_[from]);
+        }
+
+        /// @brief Adds an empty slot to the end.
+        void Grow() { entries_.emplace_back(); }
+        void Reserve(size_t size) { entries_.reserve(size); }
+
+        /// @brief Drops every slot and frees the memory.
+        void Release() { std::vector<Entry>().swap(entries_); }
+
+        /// @brief Takes the object of a slot of another array, whose slots are moving into this one.
+        Payload TakeFrom(Storage& other, size_t i) { return other.Take(i); }
+
+        /// @brief Objects live in their slots, there is no key store to clear, reserve or measure.
+        void ClearKeys() { }
+        void ReserveKeys(size_t bytes) { }
+        size_t KeyBytes() const { return 0; }
+        size_t LiveKeyBytes() const { return 0; }
+        size_t KeyCount() const { return 0; }
+
+    private:
+        struct Entry
+        {
+            Key element_{ };
+            size_t hash_ = 0;
+            SlotState info_ = SlotState::EMPTY;
+        };
+
+        std::vector<Entry> entries_;
+    };
+};
+
+/// @brief Layout that keeps the hashes and states in one array and the objects in another, so probes that do not
+/// match the hash only touch the small first array.
+struct SplitLayout
+{
+    /// @brief The slots of one array of a table.
+    /// @tparam Key The type of object stored.
+    template <typename Key>
+    class Storage
+    {
+    public:
+        /// @brief Construct an array of empty slots.
+        /// @param size The number of slots.
+        explicit Storage(size_t size = 0) : meta_(size), elements_(size)
+        { }
+
+        using Payload = Key;    // What a slot holds for its object
+
+        size_t Size() const { return meta_.size(); }
+        SlotState State(size_t i) const { return meta_[i].info_; }
+        void SetState(size_t i, SlotState state) { meta_[i].info_ = state; }
+        size_t Hash(size_t i) const { return meta_[i].hash_; }
+        const Key& Element(size_t i) const { return elements_[i]; }
+        Payload Take(size_t i) { return std::move(elements_[i]); }
+        void Prefetch(size_t i) const { __builtin_prefetch(&meta_[i]); }
+
+        /// @brief Makes the payload of an object about to be stored.
+        template <typename K>
+        Payload MakePayload(K&& x) { return Payload(std::forward<K>(x)); }
+
+        /// @brief Checks an object against a slot, comparing the hashes before the objects.
+        /// @return True if the slot holds the object, whatever its state, false otherwise.
+        template <typename K>
+        bool Matches(size_t i, const K& x, size_t hash) const
+        {
+            return meta_[i].hash_ == hash && elements_[i] == x;
+        }
+
+        /// @brief Stores an active object in a slot.
+        template <typename K>
+        void Set(size_t i, K&& x, size_t hash)
+        {
+            elements_[i] = std::forward<K>(x);
+            meta_[i].hash_ = hash;
+            meta_[i].info_ = SlotState::ACTIVE;
+        }
+
+        /// @brief Swaps the object of an active slot with an object being carried.
+        void Swap(size_t i, Payload& x, size_t& hash)
+        {
+            std::swap(elements_[i], x);
+            std::swap(meta_[i].hash_, hash);
+        }
+
+        /// @brief Moves a slot onto another.
+        void Move(size_t to, size_t from)
+        {
+            elements_[to] = std::move(elements_[from]);
+            meta_[to] = meta_[from];
+        }
+
+        /// @brief Adds an empty slot to the end.
+        void Grow()
+        {
+            meta_.emplace_back();
+            elements_.emplace_back();
+        }
+
+        void Reserve(size_t size)
+        {
+            meta_.reserve(size);
+            elements_.reserve(size);
+        }
+
+        /// @brief Drops every slot and frees the memory.
+        void Release()
+        {
+            std::vector<Meta>().swap(meta_);
+            std::vector<Key>().swap(elements_);
+        }
+
+        /// @brief Takes the object of a slot of another array, whose slots are moving into this one.
+        Payload TakeFrom(Storage& other, size_t i) { return other.Take(i); }
+
+        /// @brief Objects live in their slots, there is no key store to clear, reserve or measure.
+        void ClearKeys() { }
+        void ReserveKeys(size_t bytes) { }
+        size_t KeyBytes() const { return 0; }
+        size_t LiveKeyBytes() const { return 0; }
+        size_t KeyCount() const { return 0; }
+
+    private:
+        struct Meta
+        {
+            size_t hash_ = 0;
+            SlotState info_ = SlotState::EMPTY;
+        };
+
+        std::vector<Meta> meta_;
+        std::vector<Key> elements_;
+    };
+};
+
+/// @brief Layout for std::string keys that keeps the characters of every key back to back in one buffer. A slot only
+/// holds the offset and length of its key next to its hash and state, so the table makes no allocation per key and
+/// its slots are half the size of InlineLayout's. Every array owns its buffer, so a copy of the table copies the
+/// characters too. Removed keys keep their characters until the next rehash, which copies only the keys it moves
+/// into the buffer of the new array. The buffer holds at most 4 GiB.
+struct ArenaLayout
+{
+    /// @brief The slots of one array of a table.
+    /// @tparam Key std::string.
+    template <typename Key>
+    class Storage
+    {
+    public:
+        /// @brief Where the characters of a key are in the buffer.
+        struct Payload
+        {
+            uint32_t offset_ = 0;
+            uint32_t length_ = 0;
+        };
+
+        /// @brief Construct an array of empty slots with an empty buffer.
+        /// @param size The number of slots.
+        explicit Storage(size_t size = 0) : slots_(size)
+        { }
+
+        size_t Size() const { return slots_.size(); }
+        SlotState State(size_t i) const { return slots_[i].info_; }
+        void SetState(size_t i, SlotState state) { slots_[i].info_ = state; }
+        size_t Hash(size_t i) const { return slots_[i].hash_; }
+        void Prefetch(size_t i) const { __builtin_prefetch(&slots_[i]); }
+
+        /// @brief Gets the characters of the key of a slot.
+        std::string_view Element(size_t i) const
+        {
+            return std::string_view(keys_.data() + slots_[i].key_.offset_, slots_[i].key_.length_);
+        }
+
+        /// @brief Appends the characters of a key about to be stored to the buffer.
+        /// @throw std::length_error If the buffer would grow past the 4 GiB a Payload can point into.
+        template <typename K>
+        Payload MakePayload(const K& x)
+        {
+            std::string_view key(x);
+            if (key.size() > UINT32_MAX - keys_.size())
+                throw std::length_error("ArenaLayout: the keys of a table exceed 4 GiB");
+
+            Payload payload;
+            payload.offset_ = static_cast<uint32_t>(keys_.size());
+            payload.length_ = static_cast<uint32_t>(key.size());
+            keys_.append(key.data(), key.size());
+            ++key_count_;
+            return payload;
+        }
+
+        /// @brief Checks a key against a slot, comparing the hashes before the characters.
+        /// @return True if the slot holds the key, whatever its state, false otherwise.
+        template <typename K>
+        bool Matches(size_t i, const K& x, size_t hash) const
+        {
+            return slots_[i].hash_ == hash && Element(i) == x;
+        }
+
+        /// @brief Stores an active key in a slot.
+        void Set(size_t i, Payload x, size_t hash)
+        {
+            slots_[i].key_ = x;
+            slots_[i].hash_ = hash;
+            slots_[i].info_ = SlotState::ACTIVE;
+        }
+
+        /// @brief Swaps the key of an active slot with a key being carried.
+        void Swap(size_t i, Payload& x, size_t& hash)
+        {
+            std::swap(slots_[i].key_, x);
+            std::swap(slots_[i].hash_, hash);
+        }
+
+        /// @brief Moves a slot onto another.
+        void Move(size_t to, size_t from) { slots_[to] = slots_[from]; }
+
+        /// @brief Adds an empty slot to the end.
+        void Grow() { slots_.emplace_back(); }
+        void Reserve(size_t size) { slots_.reserve(size); }
+
+        /// @brief Drops every slot and the buffer and frees the memory.
+        void Release()
+        {
+            std::vector<Slot>().swap(slots_);
+            std::string().swap(keys_);
+            key_count_ = 0;
+        }
+
+        /// @brief Copies the characters of the key of a slot of another array, whose slots are moving into this one,
+        /// to the end of the buffer.
+        Payload TakeFrom(Storage& other, size_t i) { return MakePayload(other.Element(i)); }
+
+        /// @brief Empties the buffer, every slot must be empty.
+        void ClearKeys()
+        {
+            keys_.clear();
+            key_count_ = 0;
+        }
+        void ReserveKeys(size_t bytes) { keys_.reserve(bytes); }
+
+        /// @brief Gets the length of the buffer, the characters of removed keys included.
+        size_t KeyBytes() const { return keys_.size(); }
+
+        /// @brief Gets the number of keys in the buffer, removed keys included.
+        size_t KeyCount() const { return key_count_; }
+
+        /// @brief Gets the total length of the keys of the active slots.
+        size_t LiveKeyBytes() const
+        {
+            size_t bytes = 0;
+            for (size_t i = 0; i < slots_.size(); ++i)
+                if (slots_[i].info_ == SlotState::ACTIVE)
+                    bytes += slots_[i].key_.length_;
+            return bytes;
+        }
+
+    private:
+        struct Slot
+        {
+            size_t hash_ = 0;
+            Payload key_;
+            SlotState info_ = SlotState::EMPTY;
+        };
+
+        std::vector<Slot> slots_;
+        std::string keys_;
+        size_t key_count_ = 0;                      // Keys appended to keys_ since it was last emptied
+    };
+};
+
+
+/// @brief Open addressing hash table, the engine behind HashTableLinear, HashTable, HashTableDouble and
+/// HashTableRobinHood. Every policy is a template parameter, so probing compiles down to the code of one scheme.
+/// Every object is stored with its full hash, which probes compare before the objects and rehashing reuses.
+/// The table doubles once more than its max load factor of slots, half by default, have been inserted into, at once
+/// or incrementally.
+/// @tparam Key The type of object to store in the hash table indexed by a hash.
+/// @tparam ProbePolicy LinearProbing, QuadraticProbing, DoubleHashing or RobinHoodProbing.
+/// @tparam HashPolicy How capacities are chosen and hashes reduced to slots, see capacity_policy.h.
+/// @tparam Layout InlineLayout, SplitLayout, or ArenaLayout for std::string keys.
+template <typename Key, typename ProbePolicy, typename HashPolicy = PrimeCapacity, typename Layout = InlineLayout>
+class OpenAddressingTable
+{
+public:
+    /// @brief Construct a hash table with a given size.
+    /// @param size The size of the hash table, defaults to 101.
+    explicit OpenAddressingTable(size_t size = 101) : array_(HashPolicy::NextCapacity(size)), min_capacity_(array_.Size())
+    {
+        if (probe_.IsTuned())
+            probe_.template Tune<HashPolicy>(std::vector<size_t>(), array_.Size());
+        MakeEmpty();
+    }
+
+    /// @brief Sets a value that will be used for the double hashing computation, only for DoubleHashing. The array and
+    /// the old array of an incremental rehash share one R, so the rehash in progress is finished first, and a table
+    /// that holds objects or tombstones is rebuilt with the new R, as they were placed with the last one.
+    /// @param R The value to use for the double hashing computation, 0 or less to tune it to the objects at every
+    /// rehash from then on, which is the default.
+    void SetRValue(int R)
+    {
+        if (R > 0 && !probe_.IsTuned() && probe_.R == R)
+            return;
+
+        FinishRehash();
+        probe_.SetRValue(R);
+        if (current_size_ + deleted_size_ != 0)
+            RebuildAtOnce();
+    }
+
+    /// @brief Tunes R to the objects in the table now and rebuilds the table with it, only for DoubleHashing.
+    /// R stays tuned at every rehash from then on.
+    void TuneRValue()
+    {
+        FinishRehash();
+        probe_.SetRValue(0);
+        RebuildAtOnce();
+    }
+
+    /// @brief Get the R of double hashing, set or tuned.
+    /// @return The R value.
+    int GetRValue() const
+    {
+        return probe_.R;
+    }
+
+    /// @brief Get the mean probes of a search for each object the last tuning of R was over, with the R chosen.
+    /// @return The expected mean probes, only for DoubleHashing.
+    double GetExpectedProbes() const
+    {
+        return probe_.expected_probes_;
+    }
+
+    /// @brief Get the mean probes the same objects would have taken with the R before the last tuning.
+    /// @return The mean probes without tuning, only for DoubleHashing.
+    double GetPreviousProbes() const
+    {
+        return probe_.previous_probes_;
+    }
+
+    /// @brief Determine if the hash table contains a given object.
+    /// @tparam K Key, or a type that compares and hashes the same, such as std::string_view for std::string.
+    /// @param x The object to search for.
+    /// @return True if the object is in the hash table, false otherwise.
+    template <typename K>
+    bool Contains(const K& x)
+    {
+        size_t hash = InternalHash(x);
+        size_t old_pos;
+        return IsActive(array_, FindPos(x, hash), x, hash) || InOldArray(x, hash, old_pos);
+    }
+
+    /// @brief Determine if the hash table contains a given object without counting collisions, so any number of
+    /// threads can search a table that none of them changes.
+    /// @tparam K Key, or a type that compares and hashes the same.
+    /// @param x The object to search for.
+    /// @return True if the object is in the hash table, false otherwise.
+    template <typename K>
+    bool Contains(const K& x) const
+    {
+        return ContainsHashed(x, InternalHash(x));
+    }
+
+    /// @brief Determine which of a batch of objects the hash table contains, without counting collisions. The
+    /// objects are hashed and the home slots of a group of them requested from memory before any is searched, so
+    /// the cache misses of the group overlap instead of each search waiting on its own.
+    /// @tparam K Key, or a type that compares and hashes the same.
+    /// @param keys The objects to search for.
+    /// @param count The number of objects.
+    /// @param found Set to whether each object is in the hash table, one per object.
+    /// @return The number of objects in the hash table.
+    template <typename K>
+    size_t ContainsBatch(const K* keys, size_t count, bool* found) const
+    {
+        size_t hashes[BATCH_GROUP];
+        size_t hits = 0;
+
+        for (size_t first = 0; first < count; first += BATCH_GROUP)
+        {
+            size_t group = std::min(BATCH_GROUP, count - first);
+            for (size_t i = 0; i < group; ++i)
+            {
+                hashes[i] = InternalHash(keys[first + i]);
+                array_.Prefetch(HashPolicy::Reduce(hashes[i], array_.Size()));
+            }
+
+            for (size_t i = 0; i < group; ++i)
+            {
+                found[first + i] = ContainsHashed(keys[first + i], hashes[i]);
+                hits += found[first + i];
+            }
+        }
+
+        return hits;
+    }
+
+    /// @brief Get the current capacity of the hash table.
+    /// @return The number of slots in the hash table.
+    size_t GetCapacity() const
+    {
+        return array_.Size();
+    }
+
+    /// @brief Spreads every rehash over the operations that follow it instead of moving the whole table at once.
+    /// Until a rehash is done both arrays are searched, and every insert or remove moves a few more slots over.
+    /// @param incremental True to rehash incrementally, false to rehash all at once.
+    void SetIncrementalRehash(bool incremental)
+    {
+        incremental_ = incremental;
+        if (!incremental_)
+            FinishRehash();
+    }
+
+    /// @brief Sets the fraction of its slots the table fills before it doubles.
+    /// @param load_factor The max load factor, kept between 1/8 and the highest the probe policy allows.
+    void SetMaxLoadFactor(double load_factor)
+    {
+        max_load_factor_ = std::max(0.125, std::min(load_factor, ProbePolicy::MaxLoadFactor()));
+    }
+
+    /// @brief Get the fraction of its slots the table fills before it grows.
+    /// @return The max load factor.
+    double GetMaxLoadFactor() const
+    {
+        return max_load_factor_;
+    }
+
+    /// @brief Sets the fraction of its slots the table holds objects in before a remove shrinks it, to half of its
+    /// max load. The table never shrinks below its constructed or reserved capacity.
+    /// @param load_factor The min load factor, kept at most a quarter of the max load factor, 0 to never shrink.
+    void SetMinLoadFactor(double load_factor)
+    {
+        min_load_factor_ = std::max(0.0, load_factor);
+    }
+
+    /// @brief Get the fraction of its slots the table holds objects in before a remove shrinks it.
+    /// @return The min load factor.
+    double GetMinLoadFactor() const
+    {
+        return std::min(min_load_factor_, max_load_factor_ / 4);
+    }
+
+    /// @brief Get the amount of objects in the table, those an incremental rehash has yet to move over included.
+    /// @return The number of objects.
+    size_t GetSize() const
+    {
+        return current_size_ + old_size_;
+    }
+
+    /// @brief Get the amount of slots removed objects left tombstones in, not counting those of an incremental rehash.
+    /// @return The number of tombstones.
+    size_t GetTombstoneCount() const
+    {
+        return deleted_size_;
+    }
+
+    /// @brief Grows the table so a given number of objects fit without a rehash.
+    /// @param size The number of objects.
+    void Reserve(size_t size)
+    {
+        size_t capacity = HashPolicy::NextCapacity(static_cast<size_t>(size / max_load_factor_) + 1);
+        min_capacity_ = std::max(min_capacity_, capacity);
+        if (capacity > array_.Size())
+            Rehash(capacity);
+    }
+
+    /// @brief Reserves room for the characters of the keys, which only ArenaLayout keeps apart from the slots. Every
+    /// rehash reserves as much again.
+    /// @param bytes The total length of the keys.
+    void ReserveKeys(size_t bytes)
+    {
+        reserved_key_bytes_ = bytes;
+        array_.ReserveKeys(bytes);
+    }
+
+    /// @brief Get the length of the characters the table keeps for its keys, those of removed keys included.
+    /// @return The bytes of the key buffers, 0 unless the layout is ArenaLayout.
+    size_t GetKeyBytes() const
+    {
+        return array_.KeyBytes() + old_array_.KeyBytes();
+    }
+
+    /// @brief Get the amount of times the table has grown.
+    /// @return The number of rehashes.
+    size_t GetRehashCount() const
+    {
+        return rehashes_;
+    }
+
+    /// @brief Clears the hash table.
+    void MakeEmpty()
+    {
+        current_size_ = 0;
+        old_size_ = 0;
+        deleted_size_ = 0;
+        old_array_.Release();
+        migrate_pos_ = 0;
+        for (size_t i = 0; i < array_.Size(); ++i)
+            array_.SetState(i, SlotState::EMPTY);
+        array_.ClearKeys();
+    }
+
+    /// @brief Insert a new object into the hash table.
+    /// @param x The object to insert.
+    /// @return True if the object was inserted, false if the object already exists.
+    bool Insert(const Key& x)
+    {
+        return InsertObject(x);
+    }
+
+    /// @brief Insert a new object into the hash table.
+    /// @param x The rvalue object to insert.
+    /// @return True if the object was inserted, false if the object already exists.
+    bool Insert(Key&& x)
+    {
+        return InsertObject(std::move(x));
+    }
+
+    /// @brief Get the total amount of collisions of this hash table.
+    /// @return The total number of collisions
+    size_t GetTotalCollisions() const
+    {
+        return totalCollisions;
+    }
+
+    /// @brief Get the amount of probes for a search.
+    /// @tparam K Key, or a type that compares and hashes the same.
+    /// @return The number of probes for a search.
+    template <typename K>
+    size_t GetProbes(const K& x) const
+    {
+        size_t hash = InternalHash(x);
+        size_t current_pos;
+        size_t probes = Probe(x, hash, array_, current_pos);
+
+        // During an incremental rehash, a search the new array misses goes on to the old one.
+        if (old_array_.Size() != 0 && !IsActive(array_, current_pos, x, hash))
+            probes += Probe(x, hash, old_array_, current_pos);
+
+        return probes;
+    }
+
+    /// @brief Gathers statistics of the layout of the table from its slots. Probes are those a search for each stored
+    /// object takes, unlike the total collisions, which also count the probes of every rehash. The runs and the
+    /// chi-square statistic are over the slots of the current array, with every object at its home in it.
+    /// @return The statistics, named by the caller.
+    TableDiagnostics GetDiagnostics() const
+    {
+        TableDiagnostics diagnostics;
+        diagnostics.capacity_ = array_.Size();
+        std::vector<size_t> homes(array_.Size(), 0);
+
+        for (const Storage* array : { &array_, &old_array_ })
+        {
+            for (size_t i = 0; i < array->Size(); ++i)
+            {
+                // Slots an incremental rehash has moved out of are marked deleted too, only count the current array.
+                if (array == &array_ && array->State(i) == SlotState::DELETED)
+                    ++diagnostics.tombstones_;
+                if (array->State(i) != SlotState::ACTIVE)
+                    continue;
+
+                ++diagnostics.size_;
+                diagnostics.AddProbes(GetProbes(array->Element(i)));
+                ++homes[HashPolicy::Reduce(array->Hash(i), array_.Size())];
+            }
+        }
+
+        diagnostics.AddRuns(array_.Size(), [this](size_t i) { return array_.State(i) != SlotState::EMPTY; });
+        diagnostics.SetHomes(homes);
+        return diagnostics;
+    }
+
+    /// @brief Remove an object from the hash table.
+    /// @tparam K Key, or a type that compares and hashes the same.
+    /// @param x The object to remove.
+    /// @return True if the object was removed, false if the object was not found.
+    template <typename K>
+    bool Remove(const K& x)
+    {
+        RehashStep();
+
+        size_t hash = InternalHash(x);
+        size_t old_pos;
+        size_t current_pos = FindPos(x, hash);
+        if (IsActive(array_, current_pos, x, hash))
+        {
+            RemoveAt(array_, current_pos);
+            --current_size_;
+            if (!ProbePolicy::ROBIN_HOOD)
+                ++deleted_size_;
+        }
+        else if (InOldArray(x, hash, old_pos))
+        {
+            RemoveAt(old_array_, old_pos);
+            --old_size_;
+        }
+        else
+            return false;
+
+        Compact();
+        return true;
+    }
+
+private:
+    using Storage = typename Layout::template Storage<Key>;
+    using Payload = typename Storage::Payload;
+
+    static const size_t MIGRATE_STEP = 8;   // Slots of the old array moved over by each insert or remove
+    static const size_t GROW_STEP = 16;     // Slots of the next array built by each insert or remove
+    static constexpr size_t BATCH_GROUP = 16;  // Objects of a batch whose home slots are prefetched together
+
+    Storage array_;
+    Storage old_array_;                     // The array an incremental rehash is moving out of, empty otherwise
+    Storage next_array_;                    // The array the next rehash moves into, built ahead of it
+    ProbePolicy probe_;
+    size_t current_size_;                   // Objects in array_, which the load checks count
+    size_t old_size_ = 0;                   // Objects in old_array_ an incremental rehash has yet to move over
+    size_t deleted_size_ = 0;               // Tombstones in array_
+    size_t totalCollisions = 0;
+    size_t rehashes_ = 0;
+    double max_load_factor_ = 0.5;
+    double min_load_factor_ = 0.0625;
+    size_t min_capacity_;                   // The capacity the table never shrinks below
+    size_t reserved_key_bytes_ = 0;         // The bytes of keys every rehash reserves room for
+    size_t next_size_ = 0;                  // The size next_array_ is being built up to, 0 until it is started
+    size_t migrate_pos_ = 0;                // The next slot of old_array_ to move over
+    bool incremental_ = false;
+
+    /// @brief Inserts an object that is either copied or moved in.
+    /// @param x The object to insert.
+    /// @return True if the object was inserted, false if the object already exists.
+    template <typename K>
+    bool InsertObject(K&& x)
+    {
+        RehashStep();
+
+        // Insert x as active
+        size_t hash = InternalHash(x);
+        size_t old_pos;
+        size_t current_pos = FindPos(x, hash);
+        if (IsActive(array_, current_pos, x, hash) || InOldArray(x, hash, old_pos))
+            return false;
+
+        // A search for an object ends at its tombstone, which the object takes back.
+        if (array_.State(current_pos) == SlotState::DELETED)
+            --deleted_size_;
+        Place(array_.MakePayload(std::forward<K>(x)), hash, current_pos);
+
+        // Rehash; see Section 5.5
+        if (++current_size_ + deleted_size_ > MaxLoad())
+            Rehash();
+
+        return true;
+    }
+
+    /// @brief Gets the amount of slots that can be inserted into before the table doubles.
+    /// @return The maximum load.
+    size_t MaxLoad() const
+    {
+        return static_cast<size_t>(array_.Size() * max_load_factor_);
+    }
+
+    /// @brief Checks to see if the position a search ended at holds the object searched for.
+    /// @param array The array searched.
+    /// @param current_pos The position the search ended at.
+    /// @param x The object searched for.
+    /// @param hash The hash of the object.
+    /// @return True if the position holds the object and is active, false otherwise.
+    template <typename K>
+    bool IsActive(const Storage& array, size_t current_pos, const K& x, size_t hash) const
+    {
+        // Only Robin Hood searches end at active slots that hold other objects.
+        if (ProbePolicy::ROBIN_HOOD)
+            return array.State(current_pos) == SlotState::ACTIVE && array.Matches(current_pos, x, hash);
+
+        return array.State(current_pos) == SlotState::ACTIVE;
+    }
+
+    /// @brief Gets how far a slot of an array is past the home slot of the object it holds.
+    /// @param array The array.
+    /// @param current_pos The position of the slot.
+    /// @return The number of slots past home.
+    size_t Distance(const Storage& array, size_t current_pos) const
+    {
+        size_t home = HashPolicy::Reduce(array.Hash(current_pos), array.Size());
+        return current_pos >= home ? current_pos - home : current_pos + array.Size() - home;
+    }
+
+    /// @brief Follows the probe sequence of an object in one array of the hash table.
+    /// The search ends at the object, whatever its state, or at an empty slot. Robin Hood searches also end at the
+    /// first object closer to home than the search has come, the slot the object would take. Robin Hood tables only
+    /// have deleted slots in the old array of an incremental rehash, where they still count as taken. Robin Hood
+    /// searches need no cutoff at the largest distance in the table: past it, every object is closer to home.
+    /// @param x The object to search for.
+    /// @param hash The hash of the object.
+    /// @param array The array to search, the table or the old array of an incremental rehash.
+    /// @param current_pos Set to the position the search ends at.
+    /// @return The number of probes for the search.
+    template <typename K>
+    size_t Probe(const K& x, size_t hash, const Storage& array, size_t& current_pos) const
+    {
+        size_t capacity = array.Size();
+        size_t step = probe_.template FirstStep<HashPolicy>(hash, capacity);
+        size_t probes = 1;
+        current_pos = HashPolicy::Reduce(hash, capacity);
+
+        while (ProbePolicy::ROBIN_HOOD
+            ? array.State(current_pos) != SlotState::EMPTY && Distance(array, current_pos) >= probes - 1 && !array.Matches(current_pos, x, hash)
+            : array.State(current_pos) != SlotState::EMPTY && !array.Matches(current_pos, x, hash))
+        {
+            ++probes;
+            current_pos += step;  // Compute ith probe.
+            step = probe_.template NextStep<HashPolicy>(step);
+            if (current_pos >= capacity)
+                current_pos -= capacity;
+        }
+
+        return probes;
+    }
+
+    /// @brief Finds the position of an object in the hash table.
+    /// @param x The object to find the position of.
+    /// @param hash The hash of the object.
+    /// @return The position the search for the object ends at in the hash table.
+    template <typename K>
+    size_t FindPos(const K& x, size_t hash)
+    {
+        return FindPos(x, hash, array_);
+    }
+
+    /// @brief Finds the position of an object in one array of the hash table, counting the collisions on the way.
+    /// @param x The object to find the position of.
+    /// @param hash The hash of the object.
+    /// @param array The array to search, the table or the old array of an incremental rehash.
+    /// @return The position the search for the object ends at in the array.
+    template <typename K>
+    size_t FindPos(const K& x, size_t hash, const Storage& array)
+    {
+        size_t current_pos;
+        totalCollisions += Probe(x, hash, array, current_pos) - 1;
+        return current_pos;
+    }
+
+    /// @brief Stores an object that is not in the table at the position its search ended at. Robin Hood probing
+    /// carries every object it displaces on to the next slot that object is poorer than.
+    /// @param x The payload of the object to store.
+    /// @param hash The hash of the object.
+    /// @param current_pos The position the search for the object ended at.
+    void Place(Payload&& x, size_t hash, size_t current_pos)
+    {
+        if (!ProbePolicy::ROBIN_HOOD || array_.State(current_pos) != SlotState::ACTIVE)
+        {
+            array_.Set(current_pos, std::move(x), hash);
+            return;
+        }
+
+        Payload carried(std::move(x));
+        size_t distance = Distance(array_, current_pos);   // The slot holds an object closer to home than carried
+        array_.Swap(current_pos, carried, hash);
+
+        while (true)
+        {
+            ++distance;
+            if (++current_pos == array_.Size())
+                current_pos = 0;
+
+            if (array_.State(current_pos) != SlotState::ACTIVE)
+            {
+                array_.Set(current_pos, std::move(carried), hash);
+                return;
+            }
+
+            size_t slot_distance = Distance(array_, current_pos);
+            if (slot_distance < distance)
+            {
+                array_.Swap(current_pos, carried, hash);
+                distance = slot_distance;
+            }
+        }
+    }
+
+    /// @brief Removes the object at a position of an array. Robin Hood probing pulls the rest of the run one slot
+    /// closer to home, the others leave a tombstone. So does Robin Hood probing in the old array of an incremental
+    /// rehash, where pulling a slot back could move it behind migrate_pos_.
+    /// @param array The array.
+    /// @param current_pos The position of the object.
+    void RemoveAt(Storage& array, size_t current_pos)
+    {
+        if (!ProbePolicy::ROBIN_HOOD || &array != &array_)
+        {
+            array.SetState(current_pos, SlotState::DELETED);
+            return;
+        }
+
+        size_t next_pos = current_pos + 1 == array.Size() ? 0 : current_pos + 1;
+        while (array.State(next_pos) == SlotState::ACTIVE && Distance(array, next_pos) > 0)
+        {
+            array.Move(current_pos, next_pos);
+            current_pos = next_pos;
+            if (++next_pos == array.Size())
+                next_pos = 0;
+        }
+
+        array.SetState(current_pos, SlotState::EMPTY);
+    }
+
+    /// @brief Moves an active slot of an old array into the table, reusing its stored hash, and marks it deleted.
+    /// Objects of an old array are unique and not in the table yet.
+    /// @param array The old array.
+    /// @param i The position of the slot.
+    void MoveIn(Storage& array, size_t i)
+    {
+        size_t current_pos = FindPos(array.Element(i), array.Hash(i));
+        Place(array_.TakeFrom(array, i), array.Hash(i), current_pos);
+        array.SetState(i, SlotState::DELETED);
+        ++current_size_;
+        --old_size_;
+    }
+
+    /// @brief Searches both arrays for an object whose hash is known, without counting collisions.
+    /// @param x The object to search for.
+    /// @param hash The hash of the object.
+    /// @return True if the object is active in the table or in the old array of an incremental rehash.
+    template <typename K>
+    bool ContainsHashed(const K& x, size_t hash) const
+    {
+        size_t current_pos;
+        Probe(x, hash, array_, current_pos);
+        if (IsActive(array_, current_pos, x, hash))
+            return true;
+        if (old_array_.Size() == 0)
+            return false;
+
+        Probe(x, hash, old_array_, current_pos);
+        return IsActive(old_array_, current_pos, x, hash);
+    }
+
+    /// @brief Searches the old array of an incremental rehash for an object.
+    /// @param x The object to search for.
+    /// @param hash The hash of the object.
+    /// @param old_pos Set to the position of the object in the old array.
+    /// @return True if a rehash is in progress and the object is active in the old array, false otherwise.
+    template <typename K>
+    bool InOldArray(const K& x, size_t hash, size_t& old_pos)
+    {
+        if (old_array_.Size() == 0)
+            return false;
+
+        old_pos = FindPos(x, hash, old_array_);
+        return IsActive(old_array_, old_pos, x, hash);
+    }
+
+    /// @brief Does the share of an incremental rehash that falls to one insert or remove. Once the table is half way
+    /// to its maximum load this builds the next few slots of the array the rehash will move into, and while the rehash is in progress
+    /// it moves the next few slots of the old array over.
+    void RehashStep()
+    {
+        if (!incremental_)
+            return;
+
+        if (old_array_.Size() != 0)
+            MigrateSome();
+        else if (current_size_ + deleted_size_ > MaxLoad() / 2)
+            GrowNextArray(GROW_STEP, HashPolicy::NextCapacity(2 * array_.Size()));
+    }
+
+    /// @brief Builds the next slots of the array the next rehash moves into.
+    /// @param slots The amount of slots to build.
+    /// @param capacity The capacity of the array, an array started with another capacity is dropped.
+    void GrowNextArray(size_t slots, size_t capacity)
+    {
+        if (next_size_ != capacity)
+        {
+            next_array_ = Storage();
+            next_array_.Reserve(capacity);
+            next_size_ = capacity;
+        }
+
+        for (; slots > 0 && next_array_.Size() < next_size_; --slots)
+            next_array_.Grow();
+    }
+
+    /// @brief Moves the next slots of the old array of an incremental rehash over to the table.
+    /// @param slots The amount of slots to move over, defaults to MIGRATE_STEP.
+    void MigrateSome(size_t slots = MIGRATE_STEP)
+    {
+        for (; slots > 0 && migrate_pos_ < old_array_.Size(); --slots, ++migrate_pos_)
+            if (old_array_.State(migrate_pos_) == SlotState::ACTIVE)
+                MoveIn(old_array_, migrate_pos_);
+
+        if (old_array_.Size() != 0 && migrate_pos_ == old_array_.Size())
+        {
+            old_array_.Release();
+            migrate_pos_ = 0;
+        }
+    }
+
+    /// @brief Moves whatever is left of the old array of an incremental rehash over to the table.
+    void FinishRehash()
+    {
+        MigrateSome(old_array_.Size());
+    }
+
+    /// @brief Will resize the hash table to the next capacity of at least twice its size, or rebuild it at the same
+    /// capacity if tombstones rather than objects filled it.
+    void Rehash()
+    {
+        FinishRehash();
+        size_t capacity = array_.Size();
+        if (current_size_ > MaxLoad() / 2)
+            capacity = HashPolicy::NextCapacity(2 * capacity);
+
+        Rehash(capacity);
+    }
+
+    /// @brief Rebuilds the table after a remove, smaller once few enough objects are left in it, or at the same
+    /// capacity once tombstones outnumber the objects and fill a quarter of its max load. Searches that miss go on
+    /// past tombstones, so they would otherwise stay as slow as when the table was full. The same goes for the keys
+    /// of an ArenaLayout buffer: inserts that take back their tombstones keep the tombstones down, but every insert
+    /// appends its key, so the buffer is rebuilt with only the keys in the table once removed keys outnumber them.
+    /// All of these wait until an incremental rehash is done, the objects it has yet to move over are not counted.
+    void Compact()
+    {
+        if (old_array_.Size() != 0)
+            return;
+
+        if (array_.Size() > min_capacity_ && current_size_ < array_.Size() * GetMinLoadFactor())
+        {
+            size_t capacity = HashPolicy::NextCapacity(static_cast<size_t>(2 * current_size_ / max_load_factor_) + 1);
+            capacity = std::max(min_capacity_, capacity);
+            if (capacity < array_.Size())
+            {
+                Rehash(capacity);
+                return;
+            }
+        }
+
+        size_t threshold = std::max(current_size_, MaxLoad() / 4);
+        if (deleted_size_ > threshold || array_.KeyCount() > current_size_ + threshold)
+            Rehash(array_.Size());
+    }
+
+    /// @brief Will resize the hash table to a given capacity.
+    /// @param capacity The new capacity, which fits every object.
+    void Rehash(size_t capacity)
+    {
+        FinishRehash();
+        ++rehashes_;
+
+        // Create new empty table, or finish the one built ahead of an incremental rehash.
+        GrowNextArray(static_cast<size_t>(-1), capacity);
+        Storage old_array = std::move(array_);
+        array_ = std::move(next_array_);
+        array_.ReserveKeys(std::max(reserved_key_bytes_, old_array.LiveKeyBytes()));
+        next_array_ = Storage();
+        next_size_ = 0;
+
+        // Move table over, or leave it to the coming operations when rehashing incrementally. The old array is
+        // searched with the probing it was built with until then, so only a rehash done at once retunes it.
+        old_size_ = current_size_;
+        current_size_ = 0;
+        deleted_size_ = 0;
+        if (incremental_)
+        {
+            old_array_ = std::move(old_array);
+            return;
+        }
+
+        if (probe_.IsTuned())
+        {
+            std::vector<size_t> hashes;
+            for (size_t i = 0; i < old_array.Size(); ++i)
+                if (old_array.State(i) == SlotState::ACTIVE)
+                    hashes.push_back(old_array.Hash(i));
+            probe_.template Tune<HashPolicy>(hashes, array_.Size());
+        }
+
+        for (size_t i = 0; i < old_array.Size(); ++i)
+            if (old_array.State(i) == SlotState::ACTIVE)
+                MoveIn(old_array, i);
+    }
+
+    /// @brief Rebuilds the table at the same capacity all at once, even when rehashing incrementally, so every
+    /// object is placed with the probing as it is now.
+    void RebuildAtOnce()
+    {
+        bool incremental = incremental_;
+        incremental_ = false;
+        Rehash(array_.Size());
+        incremental_ = incremental;
+    }
+
+    /// @brief Hash function for the hash table.
+    /// @param x The object to hash.
+    /// @return The hash value of the object.
+    template <typename K>
+    size_t InternalHash(const K& x) const
+    {
+        static std::hash<K> hf;
+        return HashPolicy::Mix(hf(x));
+    }
+};
@@ -0,0 +1,415 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "capacity_policy.h"
+
+/// @brief Read only dictionary of strings behind a minimal perfect hash function, built once from a word list.
+/// Words are hashed into buckets of about four, and every bucket gets a pilot: the first number that, mixed into
+/// the hashes of its words, sends each of them to a slot no other word has. Buckets are placed largest first, while
+/// most slots are still free. Every word then has a slot of its own among exactly as many slots as there are words,
+/// so a search reads one pilot and one slot, and compares one word.
+/// The dictionary is a single image, a header followed by the pilots, the slots and the characters of the words,
+/// which Save writes to a file as is and Load maps back into memory without parsing it. The hash is computed here
+/// rather than by std::hash so saved images stay valid across builds. Images use the byte order of the machine.
+/// The header also records the size and modification time of the word list the image was built from, so a caller can
+/// tell a stale image from a current one, and Load checks every pilot and slot so a corrupted image is never read
+/// past its end.
+class PerfectHashDictionary
+{
+public:
+    /// @brief Construct an empty dictionary.
+    PerfectHashDictionary() = default;
+
+    PerfectHashDictionary(const PerfectHashDictionary&) = delete;
+    PerfectHashDictionary& operator=(const PerfectHashDictionary&) = delete;
+
+    ~PerfectHashDictionary()
+    {
+        Release();
+    }
+
+    /// @brief Builds the dictionary from a list of words, replacing what it held. Repeated words are kept once.
+    /// @param words The words.
+    /// @param source_size The size of the file the words were read from, kept in the image, 0 if there is none.
+    /// @param source_time The modification time of that file in nanoseconds, kept in the image, 0 if there is none.
+    /// @return True if the dictionary was built, false if no seed gave a perfect hash, which is all but impossible.
+    bool Build(const std::vector<std::string>& words, uint64_t source_size = 0, uint64_t source_time = 0)
+    {
+        std::vector<std::string_view> keys(words.begin(), words.end());
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        size_t bucket_count = std::max<size_t>(1, keys.size() / BUCKET_SIZE);
+        std::vector<uint32_t> pilots;
+        std::vector<uint32_t> slot_keys;
+
+        for (uint64_t seed = 0; seed < MAX_SEEDS; ++seed)
+        {
+            if (!FindPilots(keys, seed, bucket_count, pilots, slot_keys))
+                continue;
+
+            size_t blob_size = 0;
+            for (auto& key : keys)
+                blob_size += key.size();
+
+            Release();
+            buffer_.assign(ImageSize(bucket_count, keys.size(), blob_size), 0);
+            Header header{ MAGIC, seed, keys.size(), bucket_count, blob_size, source_size, source_time };
+            std::memcpy(buffer_.data(), &header, sizeof(Header));
+            Attach(buffer_.data());
+
+            // Lay the words out in slot order, so the characters of neighboring slots are neighbors too.
+            uint32_t* image_pilots = reinterpret_cast<uint32_t*>(buffer_.data() + sizeof(Header));
+            Slot* image_slots = reinterpret_cast<Slot*>(image_pilots + bucket_count);
+            char* image_blob = reinterpret_cast<char*>(image_slots + keys.size());
+            std::copy(pilots.begin(), pilots.end(), image_pilots);
+            size_t offset = 0;
+            for (size_t slot = 0; slot < keys.size(); ++slot)
+            {
+                std::string_view key = keys[slot_keys[slot]];
+                image_slots[slot] = Slot{ static_cast<uint32_t>(offset), static_cast<uint32_t>(key.size()) };
+                std::copy(key.begin(), key.end(), image_blob + offset);
+                offset += key.size();
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    /// @brief Writes the image of the dictionary to a file.
+    /// @param filename The file to write.
+    /// @return True if the file was written, false otherwise.
+    bool Save(const std::string& filename) const
+    {
+        if (header_ == nullptr)
+            return false;
+
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(header_), GetImageSize());
+        return static_cast<bool>(file);
+    }
+
+    /// @brief Maps an image written by Save into memory, replacing what the dictionary held. The image is only taken if
+    /// every pilot is one Build could have found and every slot points at characters inside the image.
+    /// @param filename The file to map.
+    /// @return True if the file holds a whole, valid image and was mapped, false otherwise, leaving the dictionary as
+    /// it was.
+    bool Load(const std::string& filename)
+    {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        void* map = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(Header))
+            map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED)
+            return false;
+
+        if (!IsValidImage(static_cast<const char*>(map), info.st_size))
+        {
+            munmap(map, info.st_size);
+            return false;
+        }
+
+        Release();
+        mapped_ = map;
+        mapped_size_ = info.st_size;
+        Attach(static_cast<const char*>(map));
+        return true;
+    }
+
+    /// @brief Determine if the dictionary contains a given word, by comparing it with the one word in its slot.
+    /// @param x The word to search for.
+    /// @return True if the word is in the dictionary, false otherwise.
+    bool Contains(std::string_view x) const
+    {
+        if (header_ == nullptr || header_->key_count_ == 0)
+            return false;
+
+        const Slot& slot = slots_[SlotOf(HashKey(x, header_->seed_))];
+        return std::string_view(blob_ + slot.offset_, slot.length_) == x;
+    }
+
+    /// @brief Determine which of a batch of words the dictionary contains. A search reads a pilot, then the slot it
+    /// leads to, then the characters of the word there, each depending on the last; the batch takes a group of words
+    /// through each step together, requesting what the next step reads for all of them before it starts.
+    /// @tparam K A type that converts to std::string_view.
+    /// @param keys The words to search for.
+    /// @param count The number of words.
+    /// @param found Set to whether each word is in the dictionary, one per word.
+    /// @return The number of words in the dictionary.
+    template <typename K>
+    size_t ContainsBatch(const K* keys, size_t count, bool* found) const
+    {
+        if (header_ == nullptr || header_->key_count_ == 0)
+        {
+            std::fill(found, found + count, false);
+            return 0;
+        }
+
+        uint64_t hashes[BATCH_GROUP];
+        size_t slots[BATCH_GROUP];
+        size_t hits = 0;
+
+        for (size_t first = 0; first < count; first += BATCH_GROUP)
+        {
+            size_t group = std::min(BATCH_GROUP, count - first);
+            for (size_t i = 0; i < group; ++i)
+            {
+                hashes[i] = HashKey(keys[first + i], header_->seed_);
+                __builtin_prefetch(&pilots_[FastRangeCapacity::Reduce(hashes[i], header_->bucket_count_)]);
+            }
+            for (size_t i = 0; i < group; ++i)
+            {
+                slots[i] = SlotOf(hashes[i]);
+                __builtin_prefetch(&slots_[slots[i]]);
+            }
+            for (size_t i = 0; i < group; ++i)
+                __builtin_prefetch(blob_ + slots_[slots[i]].offset_);
+            for (size_t i = 0; i < group; ++i)
+            {
+                const Slot& slot = slots_[slots[i]];
+                found[first + i] = std::string_view(blob_ + slot.offset_, slot.length_) == std::string_view(keys[first + i]);
+                hits += found[first + i];
+            }
+        }
+
+        return hits;
+    }
+
+    /// @brief Get the amount of probes for a search, always one.
+    /// @return The number of probes for a search.
+    size_t GetProbes(std::string_view x) const
+    {
+        return 1;
+    }
+
+    /// @brief Get the amount of slots, one per word.
+    /// @return The number of words in the dictionary.
+    size_t GetCapacity() const
+    {
+        return header_ == nullptr ? 0 : header_->key_count_;
+    }
+
+    /// @brief Get the size of the file the dictionary was built from, as given to Build.
+    /// @return The number of bytes, 0 if none was given.
+    uint64_t GetSourceSize() const
+    {
+        return header_ == nullptr ? 0 : header_->source_size_;
+    }
+
+    /// @brief Get the modification time of the file the dictionary was built from, as given to Build.
+    /// @return The time in nanoseconds, 0 if none was given.
+    uint64_t GetSourceTime() const
+    {
+        return header_ == nullptr ? 0 : header_->source_time_;
+    }
+
+    /// @brief Get the size of the image of the dictionary, in memory and on file.
+    /// @return The number of bytes.
+    size_t GetImageSize() const
+    {
+        return header_ == nullptr ? 0 : ImageSize(header_->bucket_count_, header_->key_count_, header_->blob_size_);
+    }
+
+private:
+    static const uint64_t MAGIC = 0x3248504c45505331ull;   // "1SPELPH2" read as a little-endian number
+    static const size_t BUCKET_SIZE = 4;                   // Average words per bucket
+    static const uint32_t MAX_PILOT = 1u << 24;            // Pilots tried for a bucket before the seed is given up
+    static const uint64_t MAX_SEEDS = 16;
+    static constexpr size_t BATCH_GROUP = 16;              // Words of a batch taken through each step together
+
+    struct Header
+    {
+        uint64_t magic_;
+        uint64_t seed_;
+        uint64_t key_count_;
+        uint64_t bucket_count_;
+        uint64_t blob_size_;
+        uint64_t source_size_;          // Size of the word list the image was built from
+        uint64_t source_time_;          // Modification time of that word list, in nanoseconds
+    };
+
+    /// @brief Where the characters of the word of a slot are.
+    struct Slot
+    {
+        uint32_t offset_;
+        uint32_t length_;
+    };
+
+    std::vector<char> buffer_;          // The image of a built dictionary
+    void* mapped_ = nullptr;            // The image of a loaded dictionary
+    size_t mapped_size_ = 0;
+    const Header* header_ = nullptr;
+    const uint32_t* pilots_ = nullptr;
+    const Slot* slots_ = nullptr;
+    const char* blob_ = nullptr;
+
+    /// @brief Gets the size of an image.
+    /// @return The number of bytes of the header, the pilots, the slots and the characters.
+    static size_t ImageSize(uint64_t bucket_count, uint64_t key_count, uint64_t blob_size)
+    {
+        return sizeof(Header) + bucket_count * sizeof(uint32_t) + key_count * sizeof(Slot) + blob_size;
+    }
+
+    /// @brief Checks an image read from a file before it is used: the header, the size, every pilot, and every slot.
+    /// @param image The first byte of the image.
+    /// @param size The size of the file.
+    /// @return True if searches of the image only read inside it, false otherwise.
+    static bool IsValidImage(const char* image, size_t size)
+    {
+        if (size < sizeof(Header))
+            return false;
+
+        // Bound the counts first, so the size of the image cannot overflow.
+        const Header* header = reinterpret_cast<const Header*>(image);
+        if (header->magic_ != MAGIC || header->bucket_count_ == 0 || header->bucket_count_ > size
+            || header->key_count_ > size || header->blob_size_ > size
+            || ImageSize(header->bucket_count_, header->key_count_, header->blob_size_) != size)
+            return false;
+
+        const uint32_t* pilots = reinterpret_cast<const uint32_t*>(image + sizeof(Header));
+        for (uint64_t bucket = 0; bucket < header->bucket_count_; ++bucket)
+            if (pilots[bucket] >= MAX_PILOT)
+                return false;
+
+        const Slot* slots = reinterpret_cast<const Slot*>(pilots + header->bucket_count_);
+        for (uint64_t slot = 0; slot < header->key_count_; ++slot)
+            if (uint64_t(slots[slot].offset_) + slots[slot].length_ > header->blob_size_)
+                return false;
+
+        return true;
+    }
+
+    /// @brief Points the dictionary at the parts of an image.
+    /// @param image The first byte of the image.
+    void Attach(const char* image)
+    {
+        header_ = reinterpret_cast<const Header*>(image);
+        pilots_ = reinterpret_cast<const uint32_t*>(image + sizeof(Header));
+        slots_ = reinterpret_cast<const Slot*>(pilots_ + header_->bucket_count_);
+        blob_ = reinterpret_cast<const char*>(slots_ + header_->key_count_);
+    }
+
+    /// @brief Drops the image the dictionary holds, unmapping it if it was loaded.
+    void Release()
+    {
+        if (mapped_ != nullptr)
+            munmap(mapped_, mapped_size_);
+        mapped_ = nullptr;
+        mapped_size_ = 0;
+        std::vector<char>().swap(buffer_);
+        header_ = nullptr;
+        pilots_ = nullptr;
+        slots_ = nullptr;
+        blob_ = nullptr;
+    }
+
+    /// @brief Hashes a word, FNV-1a over its characters followed by the MurmurHash3 finalizer.
+    /// @param x The word to hash.
+    /// @param seed The seed the dictionary was built with.
+    /// @return The hash value of the word.
+    static uint64_t HashKey(std::string_view x, uint64_t seed)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull ^ MixHash(seed);
+        for (unsigned char c : x)
+            hash = (hash ^ c) * 0x100000001b3ull;
+        return MixHash(hash);
+    }
+
+    /// @brief Gets the slot of a hash once its bucket has a pilot.
+    /// @param hash The hash of the word.
+    /// @param pilot The pilot of the bucket of the word.
+    /// @param key_count The number of slots.
+    /// @return The slot of the word.
+    static size_t SlotOf(uint64_t hash, uint32_t pilot, uint64_t key_count)
+    {
+        return FastRangeCapacity::Reduce(MixHash(hash ^ (pilot * 0x9e3779b97f4a7c15ull)), key_count);
+    }
+
+    size_t SlotOf(uint64_t hash) const
+    {
+        size_t bucket = FastRangeCapacity::Reduce(hash, header_->bucket_count_);
+        return SlotOf(hash, pilots_[bucket], header_->key_count_);
+    }
+
+    /// @brief Finds a pilot for every bucket with one seed.
+    /// @param keys The words, without repeats.
+    /// @param seed The seed to hash the words with.
+    /// @param bucket_count The number of buckets.
+    /// @param pilots Set to the pilot of every bucket.
+    /// @param slot_keys Set to the word, as an index into keys, that every slot holds.
+    /// @return True if every bucket got a pilot, false if one ran out of pilots to try.
+    static bool FindPilots(const std::vector<std::string_view>& keys, uint64_t seed, size_t bucket_count,
+        std::vector<uint32_t>& pilots, std::vector<uint32_t>& slot_keys)
+    {
+        size_t key_count = keys.size();
+        std::vector<uint64_t> hashes(key_count);
+        std::vector<std::vector<uint32_t>> buckets(bucket_count);
+        for (size_t i = 0; i < key_count; ++i)
+        {
+            hashes[i] = HashKey(keys[i], seed);
+            buckets[FastRangeCapacity::Reduce(hashes[i], bucket_count)].push_back(static_cast<uint32_t>(i));
+        }
+
+        std::vector<uint32_t> order(bucket_count);
+        for (size_t i = 0; i < bucket_count; ++i)
+            order[i] = static_cast<uint32_t>(i);
+        std::stable_sort(order.begin(), order.end(),
+            [&](uint32_t a, uint32_t b) { return buckets[a].size() > buckets[b].size(); });
+
+        const uint32_t FREE = static_cast<uint32_t>(-1);
+        pilots.assign(bucket_count, 0);
+        slot_keys.assign(key_count, FREE);
+        std::vector<size_t> slots;
+
+        for (uint32_t bucket : order)
+        {
+            if (buckets[bucket].empty())
+                break;
+
+            uint32_t pilot = 0;
+            for (; pilot < MAX_PILOT; ++pilot)
+            {
+                // Claim a slot for every word, giving them all back at the first one taken.
+                slots.clear();
+                for (uint32_t key : buckets[bucket])
+                {
+                    size_t slot = SlotOf(hashes[key], pilot, key_count);
+                    if (slot_keys[slot] != FREE)
+                        break;
+                    slot_keys[slot] = key;
+                    slots.push_back(slot);
+                }
+
+                if (slots.size() == buckets[bucket].size())
+                    break;
+                for (size_t slot : slots)
+                    slot_keys[slot] = FREE;
+            }
+
+            if (pilot == MAX_PILOT)
+                return false;
+            pilots[bucket] = pilot;
+        }
+
+        return true;
+    }
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "open_addressing.h"
+
+/// @brief Robin Hood linear probing implementation for a hash table.
+/// An insert takes the slot of any object that is closer to home than itself and carries that object on, so a search
+/// can stop at the first object that is closer to home than the search is. Removal shifts the rest of the run back one
+/// slot instead of leaving a tombstone. Distances from home come from the hash every slot stores.
+/// @tparam HashedObj The type of object to store in the hash table indexed by a hash.
+/// @tparam CapacityPolicy How capacities are chosen and hashes reduced to slots, see capacity_policy.h.
+/// @tparam Layout How slots are stored, see open_addressing.h.
+template <typename HashedObj, typename CapacityPolicy = PrimeCapacity, typename Layout = InlineLayout>
+using HashTableRobinHood = OpenAddressingTable<HashedObj, RobinHoodProbing, CapacityPolicy, Layout>;
@@ -1,113 +1,312 @@
 // Youssef Elshabasy
 // spell_check.cc: A simple spell checker.
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <sys/stat.h>
+#include <thread>
+#include "bk_tree.h"
+#include "bloom_filter.h"
+#include "deletion_index.h"
+#include "document_tokenizer.h"
 #include "double_hashing.h"
+#include "perfect_hash.h"
+#include "spell_pipeline.h"
+#include "suggestion_cache.h"
+#include "swiss_table.h"
 using namespace std;
 
-/// @brief Creates and fills double hashing hash table with all words from
+/// @brief Fills a hash table with all words from a dictionary file, one word per line.
+/// The lines are counted first so the table is sized once instead of rehashing as it fills.
+/// @tparam HashTableType The type of hash table to fill
 /// @param dictionary_file The file containing the dictionary
-/// @return The hash table containing the dictionary
-HashTableDouble<string> MakeDictionary(const string& dictionary_file)
+/// @param dictionary_hash The hash table to fill
+template <typename HashTableType>
+void LoadDictionary(const string& dictionary_file, HashTableType& dictionary_hash)
 {
-  HashTableDouble<string> dictionary_hash;
-  dictionary_hash.SetRValue(89);
   ifstream dictionaryFile(dictionary_file);
   string line;
 
+  size_t lines = count(istreambuf_iterator<char>(dictionaryFile), istreambuf_iterator<char>(), '\n');
+  dictionary_hash.Reserve(lines + 1);
+  dictionaryFile.clear();
+  dictionaryFile.seekg(0);
+
   while (dictionaryFile >> line)
   {
     dictionary_hash.Insert(line);
   }
+}
+
+/// @brief Creates and fills double hashing hash table with all words from
+/// @param dictionary_file The file containing the dictionary
+/// @return The hash table containing the dictionary
+HashTableDouble<string> MakeDictionary(const string& dictionary_file)
+{
+  HashTableDouble<string> dictionary_hash;
+  dictionary_hash.SetRValue(89);
+  LoadDictionary(dictionary_file, dictionary_hash);
 
   return dictionary_hash;
 }
 
-/// @brief Checks if a word is in the dictionary and will offer alternatives if not with 3 techniques
-/// @param dictionary The dictionary hash table
-/// @param document_file The file containing the document
-void SpellChecker(HashTableDouble<string>& dictionary, const string& document_file)
+/// @brief Creates and fills a double hashing hash table whose words share one buffer of characters.
+/// The buffer is sized to the dictionary file up front, so loading the words allocates it once.
+/// @param dictionary_file The file containing the dictionary
+/// @return The hash table containing the dictionary
+HashTableDouble<string, PrimeCapacity, ArenaLayout> MakeArenaDictionary(const string& dictionary_file)
+{
+  HashTableDouble<string, PrimeCapacity, ArenaLayout> dictionary_hash;
+  dictionary_hash.SetRValue(89);
+
+  ifstream dictionaryFile(dictionary_file, ios::ate);
+  if (dictionaryFile)
+    dictionary_hash.ReserveKeys(dictionaryFile.tellg());
+
+  LoadDictionary(dictionary_file, dictionary_hash);
+
+  return dictionary_hash;
+}
+
+/// @brief Fills a perfect hash dictionary with all words from a dictionary file. The image is kept next to the
+/// dictionary file with .phd appended. When it was built from a dictionary file of the same size and modification time
+/// it is mapped at once, otherwise the dictionary is built from the words and its image saved for the next run.
+/// @param dictionary_file The file containing the dictionary
+/// @param dictionary_hash The dictionary to fill
+/// @return True if the dictionary was filled, false otherwise.
+bool MakePerfectDictionary(const string& dictionary_file, PerfectHashDictionary& dictionary_hash)
 {
-  ifstream documentFile(document_file);
+  const string image_file = dictionary_file + ".phd";
+  struct stat words_info;
+  if (stat(dictionary_file.c_str(), &words_info) != 0)
+    return false;
+  uint64_t words_size = words_info.st_size;
+  uint64_t words_time = uint64_t(words_info.st_mtim.tv_sec) * 1000000000 + words_info.st_mtim.tv_nsec;
+  if (dictionary_hash.Load(image_file) && dictionary_hash.GetSourceSize() == words_size
+      && dictionary_hash.GetSourceTime() == words_time)
+    return true;
+
+  ifstream dictionaryFile(dictionary_file);
+  vector<string> words;
   string line;
-  string word = "";
+  while (dictionaryFile >> line)
+    words.push_back(line);
+
+  if (!dictionary_hash.Build(words, words_size, words_time))
+    return false;
+  if (!dictionary_hash.Save(image_file))
+    cerr << "Could not save " << image_file << endl;
+
+  return true;
+}
+
+/// @brief Builds a deletion index of all words from a dictionary file, one word per line.
+/// @param dictionary_file The file containing the dictionary
+/// @param index The index to build
+void MakeDeletionIndex(const string& dictionary_file, DeletionIndex& index)
+{
+  ifstream dictionaryFile(dictionary_file);
   vector<string> words;
+  string line;
+  while (dictionaryFile >> line)
+    words.push_back(line);
+
+  index.Build(words);
+}
+
+/// @brief Reads the bytes of a document
+/// @param document_file The file containing the document
+/// @return The text of the document
+string ReadText(const string& document_file)
+{
+  ifstream documentFile(document_file, ios::binary);
+  return string(istreambuf_iterator<char>(documentFile), istreambuf_iterator<char>());
+}
 
-  while (documentFile >> line)
+/// @brief Searches a dictionary for a batch of words at once if it can, overlapping the cache misses of the searches
+/// @tparam HashTableType The type of hash table holding the dictionary, with a ContainsBatch member
+/// @param dictionary The dictionary hash table
+/// @param keys The words to search for
+/// @param count The number of words
+/// @param found Set to whether each word is in the dictionary
+template <typename HashTableType>
+auto SearchBatch(HashTableType& dictionary, const string* keys, size_t count, bool* found, int)
+  -> decltype(dictionary.ContainsBatch(keys, count, found), void())
+{
+  dictionary.ContainsBatch(keys, count, found);
+}
+
+/// @brief Searches a dictionary without batch searches for a batch of words one at a time
+template <typename HashTableType>
+void SearchBatch(HashTableType& dictionary, const string* keys, size_t count, bool* found, long)
+{
+  for (size_t i = 0; i < count; ++i)
+    found[i] = dictionary.Contains(keys[i]);
+}
+
+/// @brief Checks if a word is in the dictionary and will offer alternatives if not with 3 techniques
+/// @tparam HashTableType The type of hash table holding the dictionary
+/// @param dictionary The dictionary hash table
+/// @param token The word to check
+/// @param index A deletion index of the dictionary to find the insertions of case A with, nullptr to try every
+/// letter at every position instead
+/// @param out The string to append the result lines to
+/// @param cache A cache of the lines of misspelled words already checked, nullptr to check every word again
+template <typename HashTableType>
+void CheckWord(HashTableType& dictionary, string_view token, const DeletionIndex* index, string& out,
+               SuggestionCache* cache = nullptr)
+{
+  const string word(token);
+  if (dictionary.Contains(word))
   {
-    for (auto& c : line)
-    {
-      if (c != ' ')
-      {
-        word += tolower(c);
-      }
-      else if (word != "")
-      {
-        if (!isalpha(word[0]) && !isdigit(word[0]))
-          word = word.substr(1);
-        if (!isalpha(word[word.size() - 1]) && !isdigit(word[word.size() - 1]))
-          word.pop_back();
+    out += word + " is CORRECT\n";
+    return;
+  }
 
-        words.push_back(word);
-        word.clear();
-      }
-    }
+  if (cache != nullptr && cache->Find(word, out))
+    return;
 
-    if (!word.empty())
-    {
-      if (!isalpha(word[0]) && !isdigit(word[0]))
-        word = word.substr(1);
-      if (!isalpha(word[word.size() - 1]) && !isdigit(word[word.size() - 1]))
-        word.pop_back();
+  const size_t start = out.size();
+  out += word + " is INCORRECT\n";
 
-      words.push_back(word);
+  // Case A: Adding one character in any possible position
+  if (index != nullptr)
+  {
+    for (auto& insertion : index->Insertions(word))
+    {
+      string temp = word;
+      temp.insert(insertion.first, 1, insertion.second);
+      out += "** " + word + " -> " + temp + " ** case A\n";
     }
-    word.clear();
   }
 
-  for (auto& word : words)
+  // The variants of every case left are searched for as one batch.
+  vector<string> variants;
+  if (index == nullptr)
   {
-    if (dictionary.Contains(word))
-      cout << word << " is CORRECT" << endl;
-    else
+    for (size_t i = 0; i < word.size() + 1; ++i)
     {
-      cout << word << " is INCORRECT" << endl;
-
-      // Case A: Adding one character in any possible position
-      for (size_t i = 0; i < word.size() + 1; ++i)
-      {
-        for (int j = 0; j < 26; ++j)
-        {
-          string temp = word;
-          temp.insert(i, 1, 'a' + j);
-          if (dictionary.Contains(temp))
-            cout << "** " << word << " -> " << temp << " ** case A" << endl;
-        }
-      }
-
-      // Case B: Removing one character
-      for (size_t i = 0; i < word.size(); ++i)
+      for (int j = 0; j < 26; ++j)
       {
         string temp = word;
-        temp.erase(i, 1);
-        if (dictionary.Contains(temp))
-          cout << "** " << word << " -> " << temp << " ** case B" << endl;
+        temp.insert(i, 1, 'a' + j);
+        variants.push_back(move(temp));
       }
+    }
+  }
 
-      // Case C: Swapping two adjacent characters
-      for (size_t i = 0; i < word.size() - 1; ++i)
-      {
-        string temp = word;
-        swap(temp[i], temp[i + 1]);
-        if (dictionary.Contains(temp))
-          cout << "** " << word << " -> " << temp << " ** case C" << endl;
-      }
+  // Case B: Removing one character
+  const size_t case_b = variants.size();
+  for (size_t i = 0; i < word.size(); ++i)
+  {
+    string temp = word;
+    temp.erase(i, 1);
+    variants.push_back(move(temp));
+  }
+
+  // Case C: Swapping two adjacent characters
+  const size_t case_c = variants.size();
+  for (size_t i = 0; i + 1 < word.size(); ++i)
+  {
+    string temp = word;
+    swap(temp[i], temp[i + 1]);
+    variants.push_back(move(temp));
+  }
+
+  unique_ptr<bool[]> found(new bool[variants.size()]);
+  SearchBatch(dictionary, variants.data(), variants.size(), found.get(), 0);
+  for (size_t i = 0; i < variants.size(); ++i)
+    if (found[i])
+      out += "** " + word + " -> " + variants[i] + (i < case_b ? " ** case A\n" : i < case_c ? " ** case B\n" : " ** case C\n");
+
+  if (cache != nullptr)
+    cache->Insert(word, out.substr(start));
+}
+
+/// @brief Checks if a word is in the dictionary and will offer alternatives if not with 3 techniques
+/// @tparam HashTableType The type of hash table holding the dictionary
+/// @param dictionary The dictionary hash table
+/// @param document_file The file containing the document
+/// @param index A deletion index of the dictionary to find the insertions of case A with, nullptr to try every
+/// letter at every position instead
+/// @param cache A cache of the lines of misspelled words already checked, nullptr to check every word again
+template <typename HashTableType>
+void SpellChecker(HashTableType& dictionary, const string& document_file, const DeletionIndex* index = nullptr,
+                  SuggestionCache* cache = nullptr)
+{
+  const string text = ReadText(document_file);
+  DocumentTokenizer tokenizer(text);
+  string_view word;
+  string out;
+  while (tokenizer.Next(word))
+  {
+    CheckWord(dictionary, word, index, out, cache);
+    cout << out;
+    out.clear();
+  }
+  cout.flush();
+}
+
+/// @brief Spell checks a document in a streaming pipeline, any number of words at a time: the document is mapped and
+/// cut into chunks, worker threads check chunks against the shared dictionary, and the results are written in order.
+/// @tparam HashTableType The type of hash table holding the dictionary, searched through a const reference
+/// @param dictionary The dictionary hash table, which no thread changes
+/// @param document_file The file containing the document
+/// @param threads The number of worker threads
+/// @param cache A cache of the lines of misspelled words already checked, shared by the workers, nullptr to check
+/// every word again
+/// @return True if the document was checked, false if it could not be read
+template <typename HashTableType>
+bool ParallelSpellChecker(const HashTableType& dictionary, const string& document_file, size_t threads,
+                          SuggestionCache* cache = nullptr)
+{
+  SpellPipeline pipeline(threads);
+  return pipeline.Run(document_file, [&dictionary, cache](string_view chunk, string& out)
+  {
+    DocumentTokenizer tokenizer(chunk);
+    string_view word;
+    while (tokenizer.Next(word))
+      CheckWord(dictionary, word, nullptr, out, cache);
+  }, cout);
+}
+
+/// @brief Checks if a word is in the dictionary and will offer every word within an edit distance if not
+/// @param dictionary The dictionary BK-tree
+/// @param document_file The file containing the document
+/// @param k The largest edit distance of an alternative
+void DistanceChecker(const BKTree& dictionary, const string& document_file, size_t k)
+{
+  const string text = ReadText(document_file);
+  DocumentTokenizer tokenizer(text);
+  string_view word;
+  while (tokenizer.Next(word))
+  {
+    // A search for the word alone only descends into children at its own distance, so try it first.
+    if (!dictionary.Search(word, 0).empty())
+    {
+      cout << word << " is CORRECT\n";
+      continue;
     }
+
+    cout << word << " is INCORRECT\n";
+    for (auto& alternative : dictionary.Search(word, k))
+      cout << "** " << word << " -> " << alternative.second << " ** distance " << alternative.first << "\n";
   }
+  cout.flush();
+}
 
-  documentFile.close();
+/// @brief Prints how well a cache of misspelled words did to standard error
+/// @param cache The cache
+void ReportCache(const SuggestionCache& cache)
+{
+  cerr << "Suggestion cache: " << cache.GetSize() << " of " << cache.GetCapacity() << " words, " << cache.GetHits()
+       << " hits, " << cache.GetMisses() << " misses (hit rate " << cache.GetHitRate() << "), " << cache.GetEvictions()
+       << " evictions" << endl;
 }
 
 /// @brief Wrapper function for spell checker
@@ -118,10 +317,84 @@ int testSpellingWrapper(int argument_count, char** argument_list)
 {
   const string document_filename(argument_list[1]);
   const string dictionary_filename(argument_list[2]);
+  const string table_flag(argument_count >= 4 ? argument_list[3] : "double");
 
   // Call functions implementing the assignment requirements.
-  HashTableDouble<string> dictionary = MakeDictionary(dictionary_filename);
-  SpellChecker(dictionary, document_filename);
+  if (table_flag == "double")
+  {
+    HashTableDouble<string> dictionary = MakeDictionary(dictionary_filename);
+    SpellChecker(dictionary, document_filename);
+  }
+  else if (table_flag == "arena")
+  {
+    HashTableDouble<string, PrimeCapacity, ArenaLayout> dictionary = MakeArenaDictionary(dictionary_filename);
+    SpellChecker(dictionary, document_filename);
+  }
+  else if (table_flag == "symspell")
+  {
+    HashTableDouble<string> dictionary = MakeDictionary(dictionary_filename);
+    DeletionIndex index;
+    MakeDeletionIndex(dictionary_filename, index);
+    SpellChecker(dictionary, document_filename, &index);
+  }
+  else if (table_flag == "distance")
+  {
+    BKTree dictionary;
+    ifstream dictionaryFile(dictionary_filename);
+    vector<string> words;
+    string line;
+    while (dictionaryFile >> line)
+      words.push_back(line);
+
+    dictionary.Build(words);
+    DistanceChecker(dictionary, document_filename, argument_count == 5 ? stoul(argument_list[4]) : 2);
+  }
+  else if (table_flag == "parallel")
+  {
+    const HashTableDouble<string> dictionary = MakeDictionary(dictionary_filename);
+    size_t threads = argument_count == 5 ? stoul(argument_list[4]) : thread::hardware_concurrency();
+    SuggestionCache cache;
+    if (!ParallelSpellChecker(dictionary, document_filename, threads, &cache))
+      cout << "Could not read " << document_filename << endl;
+    ReportCache(cache);
+  }
+  else if (table_flag == "cached")
+  {
+    HashTableDouble<string> dictionary = MakeDictionary(dictionary_filename);
+    SuggestionCache cache;
+    SpellChecker(dictionary, document_filename, nullptr, &cache);
+    ReportCache(cache);
+  }
+  else if (table_flag == "bloom")
+  {
+    BloomFilteredTable<HashTableDouble<string>> dictionary;
+    dictionary.GetTable().SetRValue(89);
+    LoadDictionary(dictionary_filename, dictionary);
+    SpellChecker(dictionary, document_filename);
+
+    cerr << "Bloom filter: " << dictionary.GetFilter().GetBytes() << " bytes, " << dictionary.GetFilterPasses()
+         << " passed, " << dictionary.GetFilterRejects() << " rejected, " << dictionary.GetFalsePositives()
+         << " false positives (rate " << dictionary.GetFalsePositiveRate() << ", expected "
+         << dictionary.GetFilter().GetExpectedFalsePositiveRate() << ")" << endl;
+  }
+  else if (table_flag == "perfect")
+  {
+    PerfectHashDictionary dictionary;
+    if (!MakePerfectDictionary(dictionary_filename, dictionary))
+    {
+      cout << "Could not build a dictionary from " << dictionary_filename << endl;
+      return 0;
+    }
+    SpellChecker(dictionary, document_filename);
+  }
+  else if (table_flag == "swiss")
+  {
+    HashTableSwiss<string> dictionary;
+    LoadDictionary(dictionary_filename, dictionary);
+    SpellChecker(dictionary, document_filename);
+  }
+  else
+    cout << "Unknown table type " << table_flag << " (User should provide double, arena, bloom, perfect, symspell, distance, parallel, cached or swiss)" << endl;
 
   return 0;
 }
@@ -132,9 +405,12 @@ int testSpellingWrapper(int argument_count, char** argument_list)
 // THERE. This main is only here for your own testing purposes.
 int main(int argc, char** argv)
 {
-  if (argc != 3)
+  if (argc < 3 || argc > 5)
   {
     cout << "Usage: " << argv[0] << " <document-file> <dictionary-file>" << endl;
+    cout << "or Usage: " << argv[0] << " <document-file> <dictionary-file> <double | arena | bloom | perfect | symspell | cached | swiss>" << endl;
+    cout << "or Usage: " << argv[0] << " <document-file> <dictionary-file> distance [k]" << endl;
+    cout << "or Usage: " << argv[0] << " <document-file> <dictionary-file> parallel [threads]" << endl;
     return 0;
   }
 
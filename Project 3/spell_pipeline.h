@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// @brief Streaming pipeline that checks a document of any size in chunks:
+/// - A reader thread maps the document and cuts it into chunks of about a megabyte that end at whitespace.
+/// - Worker threads check whole chunks at a time, each into its own output string.
+/// - The calling thread writes the outputs in document order and releases each chunk's pages once written.
+/// The reader stays at most a fixed number of chunks ahead of the writer, so the memory the pipeline uses is bounded
+/// by that window whatever the size of the document.
+class SpellPipeline
+{
+public:
+    /// @brief Construct a pipeline.
+    /// @param threads The number of worker threads, at least one.
+    /// @param chunk_size The size chunks are cut at, before they are extended to the next whitespace.
+    explicit SpellPipeline(size_t threads, size_t chunk_size = 1 << 20)
+        : threads_(std::max<size_t>(1, threads)), chunk_size_(std::max<size_t>(1, chunk_size)),
+          window_(4 * threads_)
+    { }
+
+    /// @brief Checks a document and writes what the checks produce, in document order.
+    /// @tparam ChunkChecker A callable taking a std::string_view of a chunk and a std::string to append output to.
+    /// It is called from several threads at once.
+    /// @param filename The document.
+    /// @param check The check to run on every chunk.
+    /// @param out The stream to write to.
+    /// @return True if the document was checked, false if it could not be opened or mapped.
+    template <typename ChunkChecker>
+    bool Run(const std::string& filename, ChunkChecker check, std::ostream& out)
+    {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        size_t size = info.st_size;
+        void* map = size == 0 ? nullptr : mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED)
+            return false;
+
+        text_ = static_cast<const char*>(map);
+        size_ = size;
+        chunks_.clear();
+        outputs_.assign(window_, std::string());
+        ends_.assign(window_, 0);
+        ready_.assign(window_, false);
+        read_ = 0;
+        written_ = 0;
+        done_reading_ = false;
+
+        std::thread reader(&SpellPipeline::Read, this);
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < threads_; ++i)
+            workers.emplace_back(&SpellPipeline::Work<ChunkChecker>, this, std::ref(check));
+
+        Write(out);
+
+        reader.join();
+        for (auto& worker : workers)
+            worker.join();
+        if (map != nullptr)
+            munmap(map, size);
+        return true;
+    }
+
+    /// @brief Get the amount of chunks the last run cut the document into.
+    /// @return The number of chunks.
+    size_t GetChunkCount() const
+    {
+        return read_;
+    }
+
+private:
+    /// @brief A chunk of the document, and its place in it.
+    struct Chunk
+    {
+        size_t index_;
+        size_t begin_;
+        size_t end_;
+    };
+
+    const size_t threads_;
+    const size_t chunk_size_;
+    const size_t window_;                   // Chunks the reader may be ahead of the writer
+
+    const char* text_ = nullptr;
+    size_t size_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::deque<Chunk> chunks_;              // Chunks read and not yet taken by a worker
+    std::vector<std::string> outputs_;      // Outputs of the chunks in the window, by index modulo window_
+    std::vector<size_t> ends_;              // Where those chunks end in the document
+    std::vector<bool> ready_;
+    size_t read_ = 0;                       // Chunks cut so far
+    size_t written_ = 0;                    // Chunks written so far
+    bool done_reading_ = false;
+
+    /// @brief Cuts the document into chunks, waiting whenever it is a window ahead of the writer.
+    void Read()
+    {
+        size_t begin = 0;
+        while (begin < size_)
+        {
+            size_t end = std::min(size_, begin + chunk_size_);
+            while (end < size_ && !std::isspace(static_cast<unsigned char>(text_[end])))
+                ++end;
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            changed_.wait(lock, [&] { return read_ - written_ < window_; });
+            chunks_.push_back(Chunk{ read_++, begin, end });
+            changed_.notify_all();
+            begin = end;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_reading_ = true;
+        changed_.notify_all();
+    }
+
+    /// @brief Checks chunks until the reader is done and every chunk is taken.
+    template <typename ChunkChecker>
+    void Work(ChunkChecker& check)
+    {
+        while (true)
+        {
+            Chunk chunk;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                changed_.wait(lock, [&] { return !chunks_.empty() || done_reading_; });
+                if (chunks_.empty())
+                    return;
+                chunk = chunks_.front();
+                chunks_.pop_front();
+            }
+
+            std::string output;
+            check(std::string_view(text_ + chunk.begin_, chunk.end_ - chunk.begin_), output);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            outputs_[chunk.index_ % window_] = std::move(output);
+            ends_[chunk.index_ % window_] = chunk.end_;
+            ready_[chunk.index_ % window_] = true;
+            changed_.notify_all();
+        }
+    }
+
+    /// @brief Writes the output of every chunk in order as soon as it is ready, and drops the pages of the chunks
+    /// written from memory.
+    /// @param out The stream to write to.
+    void Write(std::ostream& out)
+    {
+        const size_t page = sysconf(_SC_PAGESIZE);
+        size_t released = 0;
+
+        while (true)
+        {
+            std::string output;
+            size_t end;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                changed_.wait(lock, [&] { return ready_[written_ % window_] || (done_reading_ && written_ == read_); });
+                if (!ready_[written_ % window_])
+                    break;
+
+                output = std::move(outputs_[written_ % window_]);
+                end = ends_[written_ % window_];
+                ready_[written_ % window_] = false;
+                ++written_;
+                changed_.notify_all();
+            }
+
+            out.write(output.data(), output.size());
+
+            // The pages before the end of the chunk are done with; a later chunk sharing the last one reads it back.
+            size_t release = end / page * page;
+            if (release > released)
+            {
+                madvise(const_cast<char*>(text_) + released, release - released, MADV_DONTNEED);
+                released = release;
+            }
+        }
+
+        out.flush();
+    }
+};
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "capacity_policy.h"
+
+/// @brief Bounded memo of what the spell checker printed for misspelled words, so a typo that repeats costs one
+/// lookup instead of every variant search again. Any number of threads can share it.
+/// Words are split over shards by hash, each with its own lock, so threads rarely wait on each other. A full shard
+/// evicts with the CLOCK algorithm: entries sit in a ring with a bit set whenever they are found, and a hand sweeps
+/// the ring clearing bits until it reaches an entry whose bit is already clear. Entries found since the hand last
+/// passed get a second chance, which keeps the ones in use about as well as LRU without reordering a list on a hit.
+class SuggestionCache
+{
+public:
+    /// @brief Construct an empty cache.
+    /// @param capacity The most words the cache holds, spread over the shards and rounded up to a multiple of them.
+    /// @param shards The number of independently locked parts of the cache.
+    explicit SuggestionCache(size_t capacity = 4096, size_t shards = 16) : shards_(std::max<size_t>(1, shards))
+    {
+        size_t per_shard = std::max<size_t>(1, (capacity + shards_.size() - 1) / shards_.size());
+        for (auto& shard : shards_)
+        {
+            // The ring never reallocates, so the keys of the index can point into it.
+            shard.entries_.reserve(per_shard);
+            shard.index_.reserve(per_shard);
+        }
+    }
+
+    SuggestionCache(const SuggestionCache&) = delete;
+    SuggestionCache& operator=(const SuggestionCache&) = delete;
+
+    /// @brief Looks for a word and appends what was stored for it.
+    /// @param key The word.
+    /// @param out The string to append the stored value to.
+    /// @return True if the word was in the cache, false otherwise.
+    bool Find(std::string_view key, std::string& out)
+    {
+        Shard& shard = ShardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        auto found = shard.index_.find(key);
+        if (found == shard.index_.end())
+        {
+            ++shard.misses_;
+            return false;
+        }
+
+        Entry& entry = shard.entries_[found->second];
+        entry.referenced_ = true;
+        out += entry.value_;
+        ++shard.hits_;
+        return true;
+    }
+
+    /// @brief Stores a value for a word, evicting another word if its shard is full. A word already stored keeps the
+    /// value it has, since every thread computes the same one.
+    /// @param key The word.
+    /// @param value What the spell checker printed for it.
+    void Insert(std::string_view key, std::string value)
+    {
+        Shard& shard = ShardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex_);
+        if (shard.index_.count(key) != 0)
+            return;
+
+        size_t slot;
+        if (shard.entries_.size() < shard.entries_.capacity())
+        {
+            slot = shard.entries_.size();
+            shard.entries_.emplace_back();
+        }
+        else
+        {
+            while (shard.entries_[shard.hand_].referenced_)
+            {
+                shard.entries_[shard.hand_].referenced_ = false;
+                shard.hand_ = (shard.hand_ + 1) % shard.entries_.size();
+            }
+            slot = shard.hand_;
+            shard.hand_ = (shard.hand_ + 1) % shard.entries_.size();
+            shard.index_.erase(shard.entries_[slot].key_);
+            ++shard.evictions_;
+        }
+
+        Entry& entry = shard.entries_[slot];
+        entry.key_.assign(key.data(), key.size());
+        entry.value_ = std::move(value);
+        entry.referenced_ = false;
+        shard.index_.emplace(entry.key_, slot);
+    }
+
+    /// @brief Get the amount of searches that found their word.
+    size_t GetHits() const
+    {
+        return Sum(&Shard::hits_);
+    }
+
+    /// @brief Get the amount of searches that did not find their word.
+    size_t GetMisses() const
+    {
+        return Sum(&Shard::misses_);
+    }
+
+    /// @brief Get the amount of words dropped to make room for others.
+    size_t GetEvictions() const
+    {
+        return Sum(&Shard::evictions_);
+    }
+
+    /// @brief Get the fraction of searches that found their word.
+    /// @return The hit rate, 0 before any search.
+    double GetHitRate() const
+    {
+        size_t hits = GetHits();
+        size_t searches = hits + GetMisses();
+        return searches == 0 ? 0 : (double)hits / searches;
+    }
+
+    /// @brief Get the amount of words in the cache.
+    size_t GetSize() const
+    {
+        size_t size = 0;
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            size += shard.entries_.size();
+        }
+        return size;
+    }
+
+    /// @brief Get the most words the cache holds.
+    size_t GetCapacity() const
+    {
+        return shards_.size() * shards_[0].entries_.capacity();
+    }
+
+private:
+    struct Entry
+    {
+        std::string key_;
+        std::string value_;
+        bool referenced_ = false;   // Found since the hand last passed
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex_;
+        std::vector<Entry> entries_;                            // The ring the hand sweeps
+        std::unordered_map<std::string_view, size_t> index_;    // The slot of every word in entries_
+        size_t hand_ = 0;
+        size_t hits_ = 0;
+        size_t misses_ = 0;
+        size_t evictions_ = 0;
+    };
+
+    std::vector<Shard> shards_;
+
+    Shard& ShardOf(std::string_view key)
+    {
+        static std::hash<std::string_view> hf;
+        return shards_[FastRangeCapacity::Reduce(MixHash(hf(key)), shards_.size())];
+    }
+
+    size_t Sum(size_t Shard::*counter) const
+    {
+        size_t sum = 0;
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            sum += shard.*counter;
+        }
+        return sum;
+    }
+};
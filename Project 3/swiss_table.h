@@ -0,0 +1,447 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#include "table_diagnostics.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    const int8_t SWISS_EMPTY = -128;    // 0b10000000
+    const int8_t SWISS_DELETED = -2;    // 0b11111110, full slots hold the 7 low hash bits (0 to 127)
+    const size_t SWISS_GROUP_WIDTH = 16;
+
+    /// @brief Internal method to find the slots of a group whose control byte is a given byte.
+    /// @param group The first of the 16 control bytes of the group.
+    /// @param byte The control byte to look for.
+    /// @return A bit mask with bit i set if slot i of the group holds the byte.
+    uint32_t SwissMatchByte(const int8_t* group, int8_t byte)
+    {
+#if defined(__SSE2__)
+        __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(byte), ctrl));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < SWISS_GROUP_WIDTH; ++i)
+            if (group[i] == byte)
+                mask |= 1u << i;
+        return mask;
+#endif
+    }
+
+    /// @brief Internal method to find the slots of a group that are empty or deleted.
+    /// @param group The first of the 16 control bytes of the group.
+    /// @return A bit mask with bit i set if slot i of the group is free.
+    uint32_t SwissMatchFree(const int8_t* group)
+    {
+#if defined(__SSE2__)
+        // Both free bytes are negative, full bytes never are.
+        __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return _mm_movemask_epi8(ctrl);
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < SWISS_GROUP_WIDTH; ++i)
+            if (group[i] < 0)
+                mask |= 1u << i;
+        return mask;
+#endif
+    }
+}  // namespace
+
+
+/// @brief Swiss table implementation for a hash table.
+/// A separate array of one control byte per slot holds the 7 low bits of each hash, so a probe
+/// checks a whole group of 16 slots with one SSE2 compare and only compares the objects whose bits match.
+/// Probing moves between groups quadratically, the number of groups is always a power of two.
+/// @tparam HashedObj The type of object to store in the hash table indexed by a hash.
+template <typename HashedObj>
+class HashTableSwiss
+{
+public:
+    /// @brief Construct a hash table with a given size.
+    /// @param size The least amount of slots of the hash table, defaults to 101.
+    explicit HashTableSwiss(size_t size = 101)
+    {
+        size_t capacity = SWISS_GROUP_WIDTH;
+        while (capacity < size)
+            capacity *= 2;
+
+        ctrl_.assign(capacity, SWISS_EMPTY);
+        array_.resize(capacity);
+        min_capacity_ = capacity;
+        MakeEmpty();
+    }
+
+    /// @brief Determine if the hash table contains a given object.
+    /// @param x The object to search for.
+    /// @return True if the object is in the hash table, false otherwise.
+    bool Contains(const HashedObj& x)
+    {
+        return FindPos(x, InternalHash(x)) != NOT_FOUND;
+    }
+
+    /// @brief Get the current capacity of the hash table.
+    /// @return The number of slots in the hash table.
+    size_t GetCapacity() const
+    {
+        return array_.size();
+    }
+
+    /// @brief Sets the fraction of its slots the table fills, counting tombstones, before it is rebuilt.
+    /// @param load_factor The max load factor, kept between 1/8 and 7/8.
+    void SetMaxLoadFactor(double load_factor)
+    {
+        max_load_factor_ = std::max(0.125, std::min(load_factor, 0.875));
+    }
+
+    /// @brief Get the fraction of its slots the table fills before it grows.
+    /// @return The max load factor.
+    double GetMaxLoadFactor() const
+    {
+        return max_load_factor_;
+    }
+
+    /// @brief Sets the fraction of its slots the table holds objects in before a remove shrinks it, to half of its
+    /// max load. The table never shrinks below its constructed or reserved capacity.
+    /// @param load_factor The min load factor, kept at most a quarter of the max load factor, 0 to never shrink.
+    void SetMinLoadFactor(double load_factor)
+    {
+        min_load_factor_ = std::max(0.0, load_factor);
+    }
+
+    /// @brief Get the fraction of its slots the table holds objects in before a remove shrinks it.
+    /// @return The min load factor.
+    double GetMinLoadFactor() const
+    {
+        return std::min(min_load_factor_, max_load_factor_ / 4);
+    }
+
+    /// @brief Get the amount of objects in the table.
+    /// @return The number of objects.
+    size_t GetSize() const
+    {
+        return current_size_;
+    }
+
+    /// @brief Get the amount of slots removed objects left tombstones in.
+    /// @return The number of tombstones.
+    size_t GetTombstoneCount() const
+    {
+        return deleted_size_;
+    }
+
+    /// @brief Grows the table so a given number of objects fit without a rehash.
+    /// @param size The number of objects.
+    void Reserve(size_t size)
+    {
+        size_t capacity = array_.size();
+        while (MaxLoadOf(capacity) < size)
+            capacity *= 2;
+
+        min_capacity_ = std::max(min_capacity_, capacity);
+        if (capacity > array_.size())
+            Rehash(capacity);
+    }
+
+    /// @brief Get the amount of times the table has been rebuilt, grown or not.
+    /// @return The number of rehashes.
+    size_t GetRehashCount() const
+    {
+        return rehashes_;
+    }
+
+    /// @brief Clears the hash table.
+    void MakeEmpty()
+    {
+        current_size_ = 0;
+        deleted_size_ = 0;
+        std::fill(ctrl_.begin(), ctrl_.end(), SWISS_EMPTY);
+    }
+
+    /// @brief Insert a new object into the hash table.
+    /// @param x The object to insert.
+    /// @return True if the object was inserted, false if the object already exists.
+    bool Insert(const HashedObj& x)
+    {
+        size_t hash = InternalHash(x);
+        if (FindPos(x, hash) != NOT_FOUND)
+            return false;
+
+        array_[InsertPos(hash)] = x;
+        if (current_size_ + deleted_size_ > MaxLoad())
+            Rehash();
+
+        return true;
+    }
+
+    /// @brief Insert a new object into the hash table.
+    /// @param x The rvalue object to insert.
+    /// @return True if the object was inserted, false if the object already exists.
+    bool Insert(HashedObj&& x)
+    {
+        size_t hash = InternalHash(x);
+        if (FindPos(x, hash) != NOT_FOUND)
+            return false;
+
+        array_[InsertPos(hash)] = std::move(x);
+        if (current_size_ + deleted_size_ > MaxLoad())
+            Rehash();
+
+        return true;
+    }
+
+    /// @brief Get the total amount of collisions of this hash table.
+    /// A collision is an extra group probed, or a slot whose hash bits matched but whose object did not.
+    /// @return The total number of collisions
+    size_t GetTotalCollisions() const
+    {
+        return totalCollisions;
+    }
+
+    /// @brief Get the amount of probes for a search, each probe checks a group of 16 slots.
+    /// @return The number of probes for a search.
+    size_t GetProbes(const HashedObj& x) const
+    {
+        size_t hash = InternalHash(x);
+        size_t group = GroupOf(hash);
+        size_t probes = 1;
+
+        for (size_t step = 1; ; ++step)
+        {
+            const int8_t* ctrl = &ctrl_[group * SWISS_GROUP_WIDTH];
+
+            for (uint32_t match = SwissMatchByte(ctrl, TagOf(hash)); match != 0; match &= match - 1)
+                if (array_[group * SWISS_GROUP_WIDTH + __builtin_ctz(match)] == x)
+                    return probes;
+
+            if (SwissMatchByte(ctrl, SWISS_EMPTY) != 0)
+                return probes;
+
+            ++probes;
+            group = (group + step) & (GroupCount() - 1);
+        }
+    }
+
+    /// @brief Gathers statistics of the layout of the table. Probes count groups, the runs are of taken slots, and the
+    /// chi-square statistic is over home groups.
+    /// @return The statistics, named by the caller.
+    TableDiagnostics GetDiagnostics() const
+    {
+        TableDiagnostics diagnostics;
+        diagnostics.capacity_ = array_.size();
+        diagnostics.size_ = current_size_;
+        diagnostics.tombstones_ = deleted_size_;
+
+        std::vector<size_t> homes(GroupCount(), 0);
+        for (size_t i = 0; i < array_.size(); ++i)
+        {
+            if (ctrl_[i] < 0)
+                continue;
+            diagnostics.AddProbes(GetProbes(array_[i]));
+            ++homes[GroupOf(InternalHash(array_[i]))];
+        }
+        diagnostics.AddRuns(array_.size(), [this](size_t i) { return ctrl_[i] != SWISS_EMPTY; });
+        diagnostics.SetHomes(homes);
+        return diagnostics;
+    }
+
+    /// @brief Remove an object from the hash table.
+    /// @param x The object to remove.
+    /// @return True if the object was removed, false if the object was not found.
+    bool Remove(const HashedObj& x)
+    {
+        size_t current_pos = FindPos(x, InternalHash(x));
+        if (current_pos == NOT_FOUND)
+            return false;
+
+        // Searches only move past groups without an empty slot, so the slot
+        // only needs a tombstone when its group has no empty slot left.
+        size_t group = current_pos / SWISS_GROUP_WIDTH * SWISS_GROUP_WIDTH;
+        if (SwissMatchByte(&ctrl_[group], SWISS_EMPTY) != 0)
+            ctrl_[current_pos] = SWISS_EMPTY;
+        else
+        {
+            ctrl_[current_pos] = SWISS_DELETED;
+            ++deleted_size_;
+        }
+
+        --current_size_;
+        Compact();
+        return true;
+    }
+
+private:
+    static const size_t NOT_FOUND = static_cast<size_t>(-1);
+
+    std::vector<int8_t> ctrl_;
+    std::vector<HashedObj> array_;
+    size_t current_size_;
+    size_t deleted_size_;
+    size_t totalCollisions = 0;
+    size_t rehashes_ = 0;
+    double max_load_factor_ = 0.875;
+    double min_load_factor_ = 0.0625;
+    size_t min_capacity_;                   // The capacity the table never shrinks below
+
+    /// @brief Gets the amount of groups of 16 slots.
+    /// @return The number of groups.
+    size_t GroupCount() const
+    {
+        return array_.size() / SWISS_GROUP_WIDTH;
+    }
+
+    /// @brief Gets the amount of full and deleted slots allowed before rehashing, 7/8 of the slots by default.
+    /// @return The maximum load.
+    size_t MaxLoad() const
+    {
+        return MaxLoadOf(array_.size());
+    }
+
+    /// @brief Gets the group a probe for a hash starts at, from the bits above the control byte bits.
+    /// @param hash The hash of the object.
+    /// @return The home group.
+    size_t GroupOf(size_t hash) const
+    {
+        return (hash >> 7) & (GroupCount() - 1);
+    }
+
+    /// @brief Gets the control byte of a full slot holding an object with a given hash.
+    /// @param hash The hash of the object.
+    /// @return The 7 low bits of the hash.
+    static int8_t TagOf(size_t hash)
+    {
+        return static_cast<int8_t>(hash & 0x7F);
+    }
+
+    /// @brief Finds the position of an object in the hash table.
+    /// @param x The object to find the position of.
+    /// @param hash The hash of the object.
+    /// @return The position of the object in the hash table, NOT_FOUND if it is not in the table.
+    size_t FindPos(const HashedObj& x, size_t hash)
+    {
+        size_t group = GroupOf(hash);
+
+        for (size_t step = 1; ; ++step)
+        {
+            const int8_t* ctrl = &ctrl_[group * SWISS_GROUP_WIDTH];
+
+            for (uint32_t match = SwissMatchByte(ctrl, TagOf(hash)); match != 0; match &= match - 1)
+            {
+                size_t current_pos = group * SWISS_GROUP_WIDTH + __builtin_ctz(match);
+                if (array_[current_pos] == x)
+                    return current_pos;
+                ++totalCollisions;
+            }
+
+            if (SwissMatchByte(ctrl, SWISS_EMPTY) != 0)
+                return NOT_FOUND;
+
+            ++totalCollisions;
+            group = (group + step) & (GroupCount() - 1);  // Compute ith probe.
+        }
+    }
+
+    /// @brief Claims the first free slot on the probe sequence of a hash, the object must not be in the table.
+    /// @param hash The hash of the object to insert.
+    /// @return The position of the claimed slot.
+    size_t InsertPos(size_t hash)
+    {
+        size_t group = GroupOf(hash);
+
+        for (size_t step = 1; ; ++step)
+        {
+            uint32_t free = SwissMatchFree(&ctrl_[group * SWISS_GROUP_WIDTH]);
+            if (free != 0)
+            {
+                size_t current_pos = group * SWISS_GROUP_WIDTH + __builtin_ctz(free);
+                if (ctrl_[current_pos] == SWISS_DELETED)
+                    --deleted_size_;
+
+                ctrl_[current_pos] = TagOf(hash);
+                ++current_size_;
+                return current_pos;
+            }
+
+            group = (group + step) & (GroupCount() - 1);
+        }
+    }
+
+    /// @brief Rebuilds the table without tombstones, doubling it if more than half of the maximum load is live.
+    void Rehash()
+    {
+        size_t capacity = array_.size();
+        if (current_size_ > MaxLoadOf(capacity) / 2)
+            capacity *= 2;
+
+        Rehash(capacity);
+    }
+
+    /// @brief Rebuilds the table after a remove, smaller once few enough objects are left in it, or at the same
+    /// capacity once tombstones outnumber the objects and fill a quarter of its max load, so searches that miss stop
+    /// going on past them.
+    void Compact()
+    {
+        if (array_.size() > min_capacity_ && current_size_ < array_.size() * GetMinLoadFactor())
+        {
+            size_t capacity = array_.size();
+            while (capacity / 2 >= min_capacity_ && MaxLoadOf(capacity / 2) / 2 >= current_size_)
+                capacity /= 2;
+
+            if (capacity < array_.size())
+            {
+                Rehash(capacity);
+                return;
+            }
+        }
+
+        if (deleted_size_ > std::max(current_size_, MaxLoad() / 4))
+            Rehash(array_.size());
+    }
+
+    /// @brief Rebuilds the table without tombstones at a given capacity.
+    /// @param capacity The new capacity, a power of two that fits every object.
+    void Rehash(size_t capacity)
+    {
+        std::vector<int8_t> old_ctrl = std::move(ctrl_);
+        std::vector<HashedObj> old_array = std::move(array_);
+        ++rehashes_;
+
+        ctrl_.assign(capacity, SWISS_EMPTY);
+        array_.clear();
+        array_.resize(capacity);
+
+        // Move the objects over, they are known to be unique.
+        current_size_ = 0;
+        deleted_size_ = 0;
+        for (size_t i = 0; i < old_array.size(); ++i)
+            if (old_ctrl[i] >= 0)
+            {
+                size_t hash = InternalHash(old_array[i]);
+                array_[InsertPos(hash)] = std::move(old_array[i]);
+            }
+    }
+
+    /// @brief Gets the maximum load of a table with a given amount of slots.
+    /// @param capacity The number of slots.
+    /// @return The maximum load.
+    size_t MaxLoadOf(size_t capacity) const
+    {
+        return static_cast<size_t>(capacity * max_load_factor_);
+    }
+
+    /// @brief Hash function for the hash table.
+    /// @param x The object to hash.
+    /// @return The hash value of the object.
+    size_t InternalHash(const HashedObj& x) const
+    {
+        static std::hash<HashedObj> hf;
+        return hf(x);
+    }
+};
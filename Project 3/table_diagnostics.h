@@ -0,0 +1,210 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// @brief Statistics of the layout of a hash table, gathered by its GetDiagnostics from the slots as they are, rather
+/// than from the collision counter, which also counts the probes of every rehash. They cover:
+/// - The probes a search for each stored object takes, as a histogram, with the mean, 99th percentile and max.
+/// - The share of slots that hold tombstones.
+/// - The runs of taken slots, tombstones included, that linear probing clusters into.
+/// - How evenly the hashes spread over home slots: the chi-square statistic of the number of objects at every home
+///   against a uniform spread, and how many standard deviations it is from what a uniform hash gives.
+struct TableDiagnostics
+{
+    std::string name_;
+    size_t capacity_ = 0;
+    size_t size_ = 0;                               // Objects stored
+    size_t tombstones_ = 0;
+    std::vector<size_t> probe_histogram_;           // Objects found with each number of probes
+    std::vector<size_t> run_histogram_;             // Runs of each length
+    double chi_square_ = 0;
+    size_t buckets_ = 0;                            // Homes the chi-square statistic is over
+
+    /// @brief Counts one object found with a number of probes.
+    void AddProbes(size_t probes)
+    {
+        Add(probe_histogram_, probes);
+    }
+
+    /// @brief Counts one run of taken slots.
+    void AddRun(size_t length)
+    {
+        Add(run_histogram_, length);
+    }
+
+    /// @brief Counts the runs of a ring of slots.
+    /// @tparam IsTaken A callable telling whether a slot is taken.
+    /// @param slots The number of slots.
+    /// @param is_taken Whether a slot is taken.
+    template <typename IsTaken>
+    void AddRuns(size_t slots, IsTaken is_taken)
+    {
+        // Start after an empty slot, so a run that wraps around the end is counted once.
+        size_t start = 0;
+        while (start < slots && is_taken(start))
+            ++start;
+        if (start == slots)
+        {
+            if (slots != 0)
+                AddRun(slots);
+            return;
+        }
+
+        size_t length = 0;
+        for (size_t i = 1; i <= slots; ++i)
+        {
+            if (is_taken((start + i) % slots))
+                ++length;
+            else if (length != 0)
+            {
+                AddRun(length);
+                length = 0;
+            }
+        }
+    }
+
+    /// @brief Computes the chi-square statistic of the objects at every home against a uniform spread.
+    /// @param homes The number of objects whose home is each bucket.
+    void SetHomes(const std::vector<size_t>& homes)
+    {
+        buckets_ = homes.size();
+        chi_square_ = 0;
+        size_t objects = 0;
+        for (size_t count : homes)
+            objects += count;
+        if (objects == 0)
+            return;
+
+        double expected = (double)objects / buckets_;
+        for (size_t count : homes)
+            chi_square_ += (count - expected) * (count - expected) / expected;
+    }
+
+    double GetLoadFactor() const
+    {
+        return capacity_ == 0 ? 0 : (double)size_ / capacity_;
+    }
+
+    double GetTombstoneRatio() const
+    {
+        return capacity_ == 0 ? 0 : (double)tombstones_ / capacity_;
+    }
+
+    double GetMeanProbes() const
+    {
+        return Mean(probe_histogram_);
+    }
+
+    /// @brief Gets the probes within which a share of the objects are found.
+    /// @param share The share of objects, such as 0.99.
+    /// @return The least number of probes that finds at least the share of the objects.
+    size_t GetProbePercentile(double share) const
+    {
+        size_t total = Total(probe_histogram_);
+        size_t covered = 0;
+        for (size_t probes = 0; probes < probe_histogram_.size(); ++probes)
+        {
+            covered += probe_histogram_[probes];
+            if (covered != 0 && covered >= share * total)
+                return probes;
+        }
+        return 0;
+    }
+
+    size_t GetMaxProbes() const
+    {
+        return probe_histogram_.empty() ? 0 : probe_histogram_.size() - 1;
+    }
+
+    double GetMeanRun() const
+    {
+        return Mean(run_histogram_);
+    }
+
+    size_t GetMaxRun() const
+    {
+        return run_histogram_.empty() ? 0 : run_histogram_.size() - 1;
+    }
+
+    /// @brief Gets how far the chi-square statistic is from its expected value under a uniform hash.
+    /// @return The standard deviations above the expected value, near 0 for a good hash and large for a poor one.
+    double GetChiSquareZ() const
+    {
+        if (buckets_ < 2)
+            return 0;
+        double freedom = buckets_ - 1;
+        return (chi_square_ - freedom) / std::sqrt(2 * freedom);
+    }
+
+    /// @brief Gets the names of the columns of ToCsv.
+    static std::string CsvHeader()
+    {
+        return "table,capacity,size,load_factor,tombstones,tombstone_ratio,mean_probes,p99_probes,max_probes,"
+               "mean_run,max_run,chi_square,chi_square_z,probe_histogram";
+    }
+
+    /// @brief Gets the statistics as one line of comma separated values. The histogram is the last column, with the
+    /// objects found with 1, 2, ... probes separated by spaces.
+    std::string ToCsv() const
+    {
+        char buffer[512];
+        snprintf(buffer, sizeof(buffer), "%s,%zu,%zu,%.4f,%zu,%.6f,%.4f,%zu,%zu,%.4f,%zu,%.1f,%.2f,", name_.c_str(),
+            capacity_, size_, GetLoadFactor(), tombstones_, GetTombstoneRatio(), GetMeanProbes(),
+            GetProbePercentile(0.99), GetMaxProbes(), GetMeanRun(), GetMaxRun(), chi_square_, GetChiSquareZ());
+        return buffer + List(probe_histogram_, 1, " ");
+    }
+
+    /// @brief Gets the statistics as a JSON object, with both histograms as arrays that start at 1 probe and 1 slot.
+    std::string ToJson() const
+    {
+        char buffer[512];
+        snprintf(buffer, sizeof(buffer), "{\"table\": \"%s\", \"capacity\": %zu, \"size\": %zu, \"load_factor\": %.4f, "
+            "\"tombstones\": %zu, \"tombstone_ratio\": %.6f, \"mean_probes\": %.4f, \"p99_probes\": %zu, "
+            "\"max_probes\": %zu, \"mean_run\": %.4f, \"max_run\": %zu, \"chi_square\": %.1f, \"chi_square_z\": %.2f, ",
+            name_.c_str(), capacity_, size_, GetLoadFactor(), tombstones_, GetTombstoneRatio(), GetMeanProbes(),
+            GetProbePercentile(0.99), GetMaxProbes(), GetMeanRun(), GetMaxRun(), chi_square_, GetChiSquareZ());
+        return buffer + std::string("\"probe_histogram\": [") + List(probe_histogram_, 1, ", ")
+            + "], \"run_histogram\": [" + List(run_histogram_, 1, ", ") + "]}";
+    }
+
+private:
+    static void Add(std::vector<size_t>& histogram, size_t value)
+    {
+        if (histogram.size() <= value)
+            histogram.resize(value + 1, 0);
+        ++histogram[value];
+    }
+
+    static size_t Total(const std::vector<size_t>& histogram)
+    {
+        size_t total = 0;
+        for (size_t count : histogram)
+            total += count;
+        return total;
+    }
+
+    static double Mean(const std::vector<size_t>& histogram)
+    {
+        size_t total = Total(histogram);
+        double sum = 0;
+        for (size_t value = 0; value < histogram.size(); ++value)
+            sum += (double)value * histogram[value];
+        return total == 0 ? 0 : sum / total;
+    }
+
+    /// @brief Joins the counts of a histogram from a first value on.
+    static std::string List(const std::vector<size_t>& histogram, size_t first, const char* separator)
+    {
+        std::string list;
+        for (size_t value = first; value < histogram.size(); ++value)
+        {
+            if (value != first)
+                list += separator;
+            list += std::to_string(histogram[value]);
+        }
+        return list;
+    }
+};